@@ -14,11 +14,35 @@ static const char mainargs[MAINARGS_MAX_LEN] = TOSTRING(MAINARGS_PLACEHOLDER); /
 
 #define SERIAL_MMIO_ADDR 0xa00003f8
 #define RTC_MMIO_ADDR 0xa0000048
+#define SERIAL_TX_MMIO_ADDR 0xa0000800
 
 void putch(char ch) {
   outb(SERIAL_MMIO_ADDR, ch);
 }
 
+// 串口 TX FIFO：先将数据按字写入突发缓冲区，再向门铃寄存器写入字节数，由设备一次性发送
+#define SERIAL_TX_SIZE  (SERIAL_TX_MMIO_ADDR + 0x000)
+#define SERIAL_TX_COUNT (SERIAL_TX_MMIO_ADDR + 0x004)
+#define SERIAL_TX_BUF   (SERIAL_TX_MMIO_ADDR + 0x400)
+
+void putbuf(const char *buf, size_t len) {
+  uint32_t cap = inl(SERIAL_TX_SIZE);
+  while (len > 0) {
+    size_t n = len < cap ? len : cap;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      const uint8_t *p = (const uint8_t *)buf + i;
+      outl(SERIAL_TX_BUF + i, p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24));
+    }
+    for (; i < n; i ++) {
+      outb(SERIAL_TX_BUF + i, buf[i]);
+    }
+    outl(SERIAL_TX_COUNT, n);
+    buf += n;
+    len -= n;
+  }
+}
+
 void halt(int code) {
   // GCC/Clang 内嵌汇编语法：asm 或 __asm__
   // 后面可加 volatile 或 __volatile__ 关键字，表示该语句不应被优化，保留原样
@@ -28,6 +28,8 @@ void   srand     (unsigned int seed);
 int    rand      (void);
 void  *malloc    (size_t size);
 void   free      (void *ptr);
+void  *calloc    (size_t nmemb, size_t size);
+void  *realloc   (void *ptr, size_t size);
 int    abs       (int x);
 int    atoi      (const char *nptr);
 
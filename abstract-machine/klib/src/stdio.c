@@ -140,6 +140,45 @@ static inline void _out_char(
   }
 }
 
+// printf 的输出缓冲区：攒满一批字符后交给 putbuf 一次性发送，
+// 平台未提供 putbuf（如 native、x86）时退化为逐个 putch
+#define PRINTF_OUT_BUFFER_SIZE 256U
+
+void putbuf(const char *buf, size_t len) __attribute__((weak));
+
+static char _out_buf[PRINTF_OUT_BUFFER_SIZE];
+static size_t _out_len = 0;
+
+static void _out_flush(void) {
+  if (putbuf) {
+    putbuf(_out_buf, _out_len);
+  } else {
+    for (size_t i = 0; i < _out_len; i ++) {
+      putch(_out_buf[i]);
+    }
+  }
+  _out_len = 0;
+}
+
+/**
+ * @brief internal buffered putch output
+ */
+static inline void _out_buffered(
+  char character, void *buffer,
+  size_t idx, size_t maxlen
+) {
+  (void) buffer;
+  (void) idx;
+  (void) maxlen;
+
+  if (character) {
+    _out_buf[_out_len ++] = character;
+    if (_out_len == PRINTF_OUT_BUFFER_SIZE) {
+      _out_flush();
+    }
+  }
+}
+
 /**
  * @brief internal output function wrapper
  */
@@ -929,8 +968,9 @@ int printf(const char *fmt, ...) {
   va_list va;
 
   va_start(va, fmt);
-  const int ret = _vsnprintf(_out_char, buffer, ((size_t) -1), fmt, va);
+  const int ret = _vsnprintf(_out_buffered, buffer, ((size_t) -1), fmt, va);
   va_end(va);
+  _out_flush();
 
   return ret;
 }
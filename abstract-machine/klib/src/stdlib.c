@@ -5,9 +5,6 @@
 #if !defined(__ISA_NATIVE__) || defined(__NATIVE_USE_KLIB__)
 static unsigned long int next = 1;
 
-static bool addr_initialised = false;
-static void *addr;
-
 int rand(void) {
   // RAND_MAX assumed to be 32767
   next = next * 1103515245 + 12345;
@@ -32,23 +29,317 @@ int atoi(const char* nptr) {
   return x;
 }
 
+#if !(defined(__ISA_NATIVE__) && defined(__NATIVE_USE_KLIB__))
+
+/*
+ * 堆分配器：TLSF (Two-Level Segregated Fit)。
+ * 空闲块按大小分入两级索引的空闲链表，由两级位图定位非空链表，
+ * 分配与释放均只需常数步；释放时借助边界标记与物理相邻的空闲块合并。
+ *
+ * 块布局：[大小 | 标志] [负载 ...]。空闲块的负载开头保存空闲链表指针，
+ * 末尾保存块大小（脚标），供其后的块释放时找到它并向前合并。
+ */
+
+#define ALIGN_LOG2  3
+#define ALIGN_SIZE  (1 << ALIGN_LOG2)
+#define SL_LOG2     3
+#define SL_COUNT    (1 << SL_LOG2)
+#define FL_SHIFT    (SL_LOG2 + ALIGN_LOG2)
+#define FL_COUNT    (sizeof(size_t) * 8 - FL_SHIFT + 1)
+#define SMALL_SIZE  ((size_t) 1 << FL_SHIFT)
+
+#define BLOCK_FREE      ((size_t) 1)
+#define BLOCK_PREV_FREE ((size_t) 2)
+#define BLOCK_FLAGS     (BLOCK_FREE | BLOCK_PREV_FREE)
+
+typedef struct Block {
+  size_t size;        // 块大小（含头部），低两位为标志
+  struct Block *next; // 以下两项仅在空闲时有效，与负载重叠
+  struct Block *prev;
+} Block;
+
+#define HEADER_SIZE sizeof(size_t)
+// 空闲块需容纳头部、两个链表指针与脚标
+#define BLOCK_MIN   ROUNDUP(sizeof(Block) + sizeof(size_t), ALIGN_SIZE)
+
+static bool heap_initialised = false;
+static size_t fl_bitmap = 0;
+static uint8_t sl_bitmap[FL_COUNT] = {};
+static Block *free_lists[FL_COUNT][SL_COUNT] = {};
+
+// 最高位 1 的位置，x 不能为 0；不用 __builtin_clz 以免依赖 libgcc
+static int bit_fls(size_t x) {
+  int r = 0;
+  for (int s = sizeof(size_t) * 4; s > 0; s >>= 1) {
+    if (x >> s) {
+      x >>= s;
+      r += s;
+    }
+  }
+  return r;
+}
+
+// 最低位 1 的位置，x 不能为 0
+static int bit_ffs(size_t x) {
+  return bit_fls(x & -x);
+}
+
+static inline size_t block_size(Block *b) {
+  return b->size & ~BLOCK_FLAGS;
+}
+
+static inline Block *next_phys(Block *b) {
+  return (Block *) ((char *) b + block_size(b));
+}
+
+// 仅当 b 带有 BLOCK_PREV_FREE 标志时有效
+static inline Block *prev_phys(Block *b) {
+  return (Block *) ((char *) b - ((size_t *) b)[-1]);
+}
+
+static void mapping(size_t size, int *fl, int *sl) {
+  if (size < SMALL_SIZE) {
+    *fl = 0;
+    *sl = size >> ALIGN_LOG2;
+  } else {
+    int f = bit_fls(size);
+    *fl = f - FL_SHIFT + 1;
+    *sl = (size >> (f - SL_LOG2)) ^ SL_COUNT;
+  }
+}
+
+static void list_insert(Block *b) {
+  int fl, sl;
+
+  mapping(block_size(b), &fl, &sl);
+  b->prev = NULL;
+  b->next = free_lists[fl][sl];
+  if (b->next) {
+    b->next->prev = b;
+  }
+  free_lists[fl][sl] = b;
+  fl_bitmap |= (size_t) 1 << fl;
+  sl_bitmap[fl] |= 1 << sl;
+}
+
+static void list_remove(Block *b) {
+  int fl, sl;
+
+  mapping(block_size(b), &fl, &sl);
+  if (b->next) {
+    b->next->prev = b->prev;
+  }
+  if (b->prev) {
+    b->prev->next = b->next;
+  } else {
+    free_lists[fl][sl] = b->next;
+    if (b->next == NULL) {
+      sl_bitmap[fl] &= ~(1 << sl);
+      if (sl_bitmap[fl] == 0) {
+        fl_bitmap &= ~((size_t) 1 << fl);
+      }
+    }
+  }
+}
+
+static void mark_free(Block *b) {
+  Block *next = next_phys(b);
+
+  b->size |= BLOCK_FREE;
+  ((size_t *) next)[-1] = block_size(b);
+  next->size |= BLOCK_PREV_FREE;
+}
+
+static void mark_used(Block *b) {
+  b->size &= ~BLOCK_FREE;
+  next_phys(b)->size &= ~BLOCK_PREV_FREE;
+}
+
+// 与相邻的空闲块合并后放回空闲链表
+static void release(Block *b) {
+  Block *next;
+
+  if (b->size & BLOCK_PREV_FREE) {
+    Block *prev = prev_phys(b);
+    list_remove(prev);
+    prev->size += block_size(b);
+    b = prev;
+  }
+  next = next_phys(b);
+  if (next->size & BLOCK_FREE) {
+    list_remove(next);
+    b->size += block_size(next);
+  }
+  mark_free(b);
+  list_insert(b);
+}
+
+// 将 b 截为 size 字节，剩余部分足够大时作为新的空闲块释放
+static void split(Block *b, size_t size) {
+  Block *rest;
+
+  if (block_size(b) < size + BLOCK_MIN) {
+    return;
+  }
+  rest = (Block *) ((char *) b + size);
+  rest->size = block_size(b) - size;
+  b->size = size | (b->size & BLOCK_FLAGS);
+  release(rest);
+}
+
+// 找到不小于 size 的空闲块并将其移出空闲链表
+static Block *find_free(size_t size) {
+  size_t fl_map;
+  unsigned sl_map;
+  int fl, sl;
+  Block *b;
+
+  // 向上取整到下一个二级区间的起点，保证该区间内的任意块都足够大
+  if (size >= SMALL_SIZE) {
+    size += ((size_t) 1 << (bit_fls(size) - SL_LOG2)) - 1;
+  }
+  mapping(size, &fl, &sl);
+  if ((size_t) fl >= FL_COUNT) {
+    return NULL;
+  }
+
+  sl_map = sl_bitmap[fl] & (~0u << sl);
+  if (sl_map == 0) {
+    fl_map = fl + 1 < FL_COUNT ? fl_bitmap & (~(size_t) 0 << (fl + 1)) : 0;
+    if (fl_map == 0) {
+      return NULL;
+    }
+    fl = bit_ffs(fl_map);
+    sl_map = sl_bitmap[fl];
+  }
+  sl = bit_ffs(sl_map);
+
+  b = free_lists[fl][sl];
+  list_remove(b);
+  return b;
+}
+
+static void heap_init(void) {
+  uintptr_t start, end;
+  Block *b, *sentinel;
+
+  heap_initialised = true;
+  // 使负载按 ALIGN_SIZE 对齐
+  start = ROUNDUP((uintptr_t) heap.start + HEADER_SIZE, ALIGN_SIZE) - HEADER_SIZE;
+  end = (uintptr_t) heap.end;
+  if (end < start + BLOCK_MIN + HEADER_SIZE) {
+    return;
+  }
+
+  // 堆末尾放一个大小为 0 的已分配块作为哨兵，合并时不会越过堆的边界
+  b = (Block *) start;
+  b->size = ROUNDDOWN(end - HEADER_SIZE - start, ALIGN_SIZE);
+  sentinel = next_phys(b);
+  sentinel->size = 0;
+  mark_free(b);
+  list_insert(b);
+}
+
+static size_t adjust_size(size_t size) {
+  if (size > ((size_t) -1 >> 1)) {
+    return 0;
+  }
+  size = ROUNDUP(size + HEADER_SIZE, ALIGN_SIZE);
+  return size < BLOCK_MIN ? BLOCK_MIN : size;
+}
+
+void *malloc(size_t size) {
+  Block *b;
+
+  if (!heap_initialised) {
+    heap_init();
+  }
+  size = adjust_size(size);
+  if (size == 0 || (b = find_free(size)) == NULL) {
+    return NULL;
+  }
+  split(b, size);
+  mark_used(b);
+  return (char *) b + HEADER_SIZE;
+}
+
+void free(void *ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+  release((Block *) ((char *) ptr - HEADER_SIZE));
+}
+
+void *calloc(size_t nmemb, size_t size) {
+  void *ptr;
+
+  if (nmemb != 0 && size > (size_t) -1 / nmemb) {
+    return NULL;
+  }
+  ptr = malloc(nmemb * size);
+  if (ptr) {
+    memset(ptr, 0, nmemb * size);
+  }
+  return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+  Block *b, *next;
+  size_t adjusted;
+  void *res;
+
+  if (ptr == NULL) {
+    return malloc(size);
+  }
+  if (size == 0) {
+    free(ptr);
+    return NULL;
+  }
+  adjusted = adjust_size(size);
+  if (adjusted == 0) {
+    return NULL;
+  }
+
+  b = (Block *) ((char *) ptr - HEADER_SIZE);
+  if (block_size(b) < adjusted) {
+    // 优先就地吞并其后的空闲块，避免拷贝
+    next = next_phys(b);
+    if (!(next->size & BLOCK_FREE) || block_size(b) + block_size(next) < adjusted) {
+      res = malloc(size);
+      if (res) {
+        memcpy(res, ptr, block_size(b) - HEADER_SIZE);
+        free(ptr);
+      }
+      return res;
+    }
+    list_remove(next);
+    b->size += block_size(next);
+  }
+  split(b, adjusted);
+  mark_used(b);
+  return ptr;
+}
+
+#else
+
 void *malloc(size_t size) {
   // On native, malloc() will be called during initializaion of C runtime.
   // Therefore do not call panic() here, else it will yield a dead recursion:
   //   panic() -> putchar() -> (glibc) -> malloc() -> panic()
-#if !(defined(__ISA_NATIVE__) && defined(__NATIVE_USE_KLIB__))
-  if (!addr_initialised) {
-    addr = heap.start;
-    addr_initialised = true;
-  }
-  void *result = addr;
-  addr += size;
-  return result;
-#endif
   return NULL;
 }
 
 void free(void *ptr) {
 }
 
+void *calloc(size_t nmemb, size_t size) {
+  return NULL;
+}
+
+void *realloc(void *ptr, size_t size) {
+  return NULL;
+}
+
+#endif
+
 #endif
@@ -4,6 +4,41 @@
 
 #if !defined(__ISA_NATIVE__) || defined(__NATIVE_USE_KLIB__)
 
+// RV32 目标上每次访存都代价高昂，改为按对齐的 4 字节字整体读写；
+// 非对齐部分的拼接依赖小端序，因此仅对这些 ISA 启用。
+#if defined(__ISA_RISCV32__) || defined(__ISA_RISCV32E__)
+#define KLIB_STRING_WORDWISE
+#endif
+
+#ifdef KLIB_STRING_WORDWISE
+
+typedef uint32_t __attribute__((may_alias)) kword_t;
+
+#define WORD_SIZE     sizeof(kword_t)
+#define WORD_ALIGNED(p) (((uintptr_t) (p) & (WORD_SIZE - 1)) == 0)
+#define WORD_ONES     0x01010101u
+#define WORD_HIGHS    0x80808080u
+// 字中存在值为 0 的字节时结果非 0
+#define HAS_ZERO_BYTE(w) (((w) - WORD_ONES) & ~(w) & WORD_HIGHS)
+
+size_t strlen(const char *s) {
+  const char *p;
+  const kword_t *w;
+
+  for (p = s; !WORD_ALIGNED(p); p++) {
+    if (*p == '\0') {
+      return p - s;
+    }
+  }
+  // 对齐读取的字不会越过结束符所在的字，多读的字节不会造成越界访问
+  for (w = (const kword_t *) p; !HAS_ZERO_BYTE(*w); w++);
+  for (p = (const char *) w; *p; p++);
+
+  return p - s;
+}
+
+#else
+
 size_t strlen(const char *s) {
   size_t c;
   const char *p;
@@ -16,6 +51,8 @@ size_t strlen(const char *s) {
   return c;
 }
 
+#endif
+
 char *strcpy(char *dst, const char *src) {
   size_t i;
 
@@ -53,11 +90,31 @@ char *strcat(char *dst, const char *src) {
 }
 
 int strcmp(const char *s1, const char *s2) {
+#ifdef KLIB_STRING_WORDWISE
+  const kword_t *w1, *w2;
+
+  if (WORD_ALIGNED((uintptr_t) s1 ^ (uintptr_t) s2)) {
+    for (; !WORD_ALIGNED(s1); s1++, s2++) {
+      if (*s1 == '\0' || *s1 != *s2) {
+        goto out;
+      }
+    }
+    // 逐字比较，遇到不相等的字或结束符后交由下面的逐字节比较得出结果
+    for (w1 = (const kword_t *) s1, w2 = (const kword_t *) s2;
+        *w1 == *w2 && !HAS_ZERO_BYTE(*w1); w1++, w2++);
+    s1 = (const char *) w1;
+    s2 = (const char *) w2;
+  }
+#endif
+
   while (*s1 && (*s1 == *s2)) {
     s1++;
     s2++;
   }
 
+#ifdef KLIB_STRING_WORDWISE
+out:
+#endif
   return ((int) *((const unsigned char *) s1)) -
     ((int) *((const unsigned char *) s2));
 }
@@ -74,6 +131,126 @@ int strncmp(const char *s1, const char *s2, size_t n) {
   return 0;
 }
 
+#ifdef KLIB_STRING_WORDWISE
+
+void *memset(void *s, int c, size_t n) {
+  unsigned char *d = s;
+  kword_t *wd, w;
+
+  for (; n > 0 && !WORD_ALIGNED(d); n--) {
+    *d++ = (unsigned char) c;
+  }
+
+  w = (unsigned char) c * WORD_ONES;
+  for (wd = (kword_t *) d; n >= 4 * WORD_SIZE; n -= 4 * WORD_SIZE, wd += 4) {
+    wd[0] = w;
+    wd[1] = w;
+    wd[2] = w;
+    wd[3] = w;
+  }
+  for (; n >= WORD_SIZE; n -= WORD_SIZE) {
+    *wd++ = w;
+  }
+
+  for (d = (unsigned char *) wd; n > 0; n--) {
+    *d++ = (unsigned char) c;
+  }
+
+  return s;
+}
+
+// 从低地址向高地址拷贝，目的地址在源地址之前时即使重叠也是正确的
+static void copy_forward(unsigned char *d, const unsigned char *s, size_t n) {
+  kword_t *wd;
+  const kword_t *ws;
+  kword_t lo, hi;
+  unsigned shift;
+
+  for (; n > 0 && !WORD_ALIGNED(d); n--) {
+    *d++ = *s++;
+  }
+
+  wd = (kword_t *) d;
+  shift = ((uintptr_t) s & (WORD_SIZE - 1)) * 8;
+  if (shift == 0) {
+    for (ws = (const kword_t *) s; n >= 4 * WORD_SIZE; n -= 4 * WORD_SIZE, wd += 4, ws += 4) {
+      wd[0] = ws[0];
+      wd[1] = ws[1];
+      wd[2] = ws[2];
+      wd[3] = ws[3];
+    }
+    for (; n >= WORD_SIZE; n -= WORD_SIZE) {
+      *wd++ = *ws++;
+    }
+  } else if (n >= WORD_SIZE) {
+    // 源地址未对齐：读取对齐的字，按小端序移位拼接成目的字
+    ws = (const kword_t *) (s - shift / 8);
+    for (lo = *ws++; n >= WORD_SIZE; n -= WORD_SIZE, lo = hi) {
+      hi = *ws++;
+      *wd++ = (lo >> shift) | (hi << (32 - shift));
+    }
+    ws = (const kword_t *) ((const unsigned char *) ws - WORD_SIZE + shift / 8);
+  } else {
+    ws = (const kword_t *) s;
+  }
+
+  for (d = (unsigned char *) wd, s = (const unsigned char *) ws; n > 0; n--) {
+    *d++ = *s++;
+  }
+}
+
+// 从高地址向低地址拷贝，仅在两者对齐方式相同时按字进行
+static void copy_backward(unsigned char *d, const unsigned char *s, size_t n) {
+  kword_t *wd;
+  const kword_t *ws;
+
+  d += n;
+  s += n;
+  if (WORD_ALIGNED((uintptr_t) d ^ (uintptr_t) s)) {
+    for (; n > 0 && !WORD_ALIGNED(d); n--) {
+      *--d = *--s;
+    }
+    for (wd = (kword_t *) d, ws = (const kword_t *) s; n >= 4 * WORD_SIZE; n -= 4 * WORD_SIZE) {
+      wd -= 4;
+      ws -= 4;
+      wd[3] = ws[3];
+      wd[2] = ws[2];
+      wd[1] = ws[1];
+      wd[0] = ws[0];
+    }
+    for (; n >= WORD_SIZE; n -= WORD_SIZE) {
+      *--wd = *--ws;
+    }
+    d = (unsigned char *) wd;
+    s = (const unsigned char *) ws;
+  }
+
+  for (; n > 0; n--) {
+    *--d = *--s;
+  }
+}
+
+void *memmove(void *dst, const void *src, size_t n) {
+  unsigned char *d = dst;
+  const unsigned char *s = src;
+
+  if (d < s || d >= s + n) {
+    copy_forward(d, s, n);
+  } else if (d > s) {
+    copy_backward(d, s, n);
+  }
+
+  return dst;
+}
+
+void *memcpy(void *out, const void *in, size_t n) {
+  // 调用者保证两者不重叠，无需 memmove 的方向判断
+  copy_forward(out, in, n);
+  return out;
+}
+
+#else
+
 void *memset(void *s, int c, size_t n) {
   unsigned char *dest = s;
   size_t i;
@@ -109,6 +286,8 @@ void *memcpy(void *out, const void *in, size_t n) {
   return memmove(out, in, n);
 }
 
+#endif
+
 int memcmp(const void *s1, const void *s2, size_t n) {
   const unsigned char *s1p, *s2p;
   int res;
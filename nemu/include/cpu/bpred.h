@@ -0,0 +1,35 @@
+#ifndef __CPU_BPRED_H__
+#define __CPU_BPRED_H__
+
+#include <common.h>
+
+#ifdef CONFIG_BPRED
+
+/* 控制转移指令的类别，由各 ISA 在执行后识别 */
+typedef enum {
+    BRANCH_COND,     // 条件分支
+    BRANCH_JUMP,     // 目的地址固定的直接跳转
+    BRANCH_CALL,     // 函数调用（直接或间接）
+    BRANCH_RET,      // 函数返回
+    BRANCH_INDIRECT, // 其余的间接跳转
+    NR_BRANCH_KIND
+} BranchKind;
+
+typedef struct {
+    vaddr_t pc;
+    BranchKind kind;
+    bool taken;
+    /* 跳转时的目的地址，条件分支不跳转时同样给出 */
+    vaddr_t target;
+    /* 顺序执行的下一条指令地址，即函数调用的返回地址 */
+    vaddr_t fallthrough;
+} BranchInfo;
+
+/* 每条控制转移指令执行后调用，所有预测器在同一遍执行中并行评估 */
+void bpred_branch(const BranchInfo *b);
+
+void bpred_dump(void);
+
+#endif
+
+#endif
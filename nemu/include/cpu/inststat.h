@@ -0,0 +1,44 @@
+#ifndef __CPU_INSTSTAT_H__
+#define __CPU_INSTSTAT_H__
+
+#include <common.h>
+#include <cpu/decode.h>
+
+#ifdef CONFIG_INSTSTAT
+
+#define INSTSTAT_BLOCK_TABLE_SIZE 65536
+
+/* 每个 INSTPAT 对应一个计数器，统一放在 nemu_inststat 段中，导出时由链接器给出段的起止地址遍历 */
+typedef struct {
+    const char *name;
+    uint64_t count;
+} __attribute__((aligned(16))) InstStat;
+
+#define INSTSTAT_INC(inst) do { \
+    static InstStat __inststat __attribute__((section("nemu_inststat"), used)) = { .name = str(inst) }; \
+    __inststat.count ++; \
+} while (0)
+
+/* 上一条指令是否为条件分支，不论是否跳转都会结束当前基本块 */
+extern bool inststat_block_end;
+
+/* 以访存宽度（字节）为索引的 load/store 次数 */
+extern uint64_t inststat_load_size[9];
+extern uint64_t inststat_store_size[9];
+
+void inststat_start(vaddr_t pc);
+
+void inststat_new_block(Decode *s);
+
+/* 每执行完一条指令后调用，控制流发生转移时进入新的基本块 */
+static inline void inststat_exec(Decode *s) {
+    if (unlikely(inststat_block_end || s->dnpc != s->snpc)) {
+        inststat_new_block(s);
+    }
+}
+
+void inststat_dump(void);
+
+#endif
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef __CPU_SIMPOINT_H__
+#define __CPU_SIMPOINT_H__
+
+#include <common.h>
+
+#ifdef CONFIG_SIMPOINT
+
+/*
+ * 检查点文件格式（小端序）：
+ *   SimpointCkptHeader
+ *   CPU_state（与 difftest_regcpy 交换的结构相同）
+ *   nr_pages 个 { uint64_t paddr; uint8_t data[SIMPOINT_CKPT_PAGE_SIZE]; }，只保存非零页
+ */
+#define SIMPOINT_CKPT_MAGIC "NEMUCKPT"
+#define SIMPOINT_CKPT_PAGE_SIZE 4096
+
+typedef struct {
+    char magic[8];
+    uint64_t interval;
+    uint64_t inst_count;
+    uint64_t state_size;
+    uint64_t nr_pages;
+} SimpointCkptHeader;
+
+void init_simpoint(const char *simpoints_file);
+
+void simpoint_block(uint32_t id, uint64_t insts);
+
+void simpoint_interval_end(void);
+
+void simpoint_finish(void);
+
+#endif
+
+#endif
@@ -36,4 +36,10 @@ word_t paddr_read_mtrace(paddr_t addr, int len, bool mtrace_on);
 void paddr_write(paddr_t addr, int len, word_t data);
 void paddr_write_mtrace(paddr_t addr, int len, word_t data, bool mtrace_on);
 
+#ifdef CONFIG_CACHESIM
+#include <utils/cachesim.h>
+void paddr_cachesim_access(paddr_t addr, int len, CacheAccessType type);
+void paddr_cachesim_report(uint64_t insts);
+#endif
+
 #endif
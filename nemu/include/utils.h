@@ -29,11 +29,27 @@ enum { NEMU_RUNNING, NEMU_STOP, NEMU_END, NEMU_ABORT, NEMU_QUIT };
 
 #define CALL_STACK_MAX_DEPTH 1024
 
+#ifdef CONFIG_ITRACE
+
+// iringbuf 保留的指令条数，须为 2 的幂
+#define NEMU_IRINGBUF_SIZE 32
+
+/* iringbuf 中的一条记录，只保存 PC 与指令的原始字节，输出时才反汇编 */
+typedef struct {
+  vaddr_t pc;
+  uint8_t ilen;
+  uint8_t inst[MUXDEF(CONFIG_ISA_x86, 16, 4)];
+} IRingBufEntry;
+
+#endif
+
 typedef struct {
   int state;
   vaddr_t halt_pc;
   uint32_t halt_ret;
-  IFDEF(CONFIG_ITRACE, RingBuffer *iringbuf);
+  IFDEF(CONFIG_ITRACE, IRingBufEntry iringbuf[NEMU_IRINGBUF_SIZE]);
+  IFDEF(CONFIG_ITRACE, uint64_t iringbuf_count);
+  IFDEF(CONFIG_ITRACE, uint64_t iringbuf_dumped);
   IFDEF(CONFIG_MTRACE, bool mtrace_available);
   IFDEF(CONFIG_MTRACE, char mtrace_logbuf[4096]);
   IFDEF(CONFIG_FTRACE, Symbol ftrace_func_syms[1024]);
@@ -52,16 +68,22 @@ extern NEMUState nemu_state;
 
 #ifdef CONFIG_ITRACE
 
-#define NEMU_IRINGBUF_SIZE 1024
+#define nemu_iringbuf (nemu_state.iringbuf)
 
-bool nemu_iringbuf_init(void);
+/* 每条指令执行后调用，只写入一条记录 */
+static inline void nemu_iringbuf_record(vaddr_t pc, const void *inst, int ilen) {
+  IRingBufEntry *e = &nemu_iringbuf[nemu_state.iringbuf_count++ & (NEMU_IRINGBUF_SIZE - 1)];
+  e->pc = pc;
+  e->ilen = ilen;
+  memcpy(e->inst, inst, sizeof(e->inst));
+}
 
-void nemu_iringbuf_destroy(void);
+/* 将一条指令格式化为 itrace 的一行：地址、指令字节与反汇编结果 */
+void nemu_itrace_format(char *buf, int size, vaddr_t pc, const uint8_t *inst, int ilen);
 
+/* 反汇编并输出自上次输出以来记录的指令 */
 void nemu_iringbuf_dump(void);
 
-#define nemu_iringbuf (nemu_state.iringbuf)
-
 #endif
 
 #ifdef CONFIG_FTRACE
@@ -70,6 +92,14 @@ bool nemu_ftrace_record_and_log(CallType type, word_t src_addr, word_t addr);
 
 #endif
 
+#ifdef CONFIG_SAMPLER
+
+void sampler_sample(vaddr_t pc);
+
+void sampler_dump(void);
+
+#endif
+
 // ----------- timer -----------
 
 uint64_t get_time();
@@ -0,0 +1,49 @@
+#ifndef __UTILS_CACHESIM_H__
+#define __UTILS_CACHESIM_H__
+
+/*
+ * 缓存模拟器：按给定配置模拟 L1I/L1D 与可选的 L2，统计命中率、MPKI 与 AMAT。
+ * 不依赖 NEMU 的其余部分，NPC 的仿真环境同样直接使用本库。
+ *
+ * 配置字符串形如
+ *   l1i=16K:4:64:lru:1,l1d=32K:8:64:plru:wb:1,l2=256K:8:64:lru:wb:10,mem=100
+ * 每一级依次为 容量:路数:行大小，其后可跟替换策略 (lru/plru/random)、
+ * 写策略 (wb/wt) 与命中延迟（周期），缺省为 lru、wb、1。
+ * 多个配置之间以 '|' 分隔，它们在同一遍访存序列中并行模拟。
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    CACHE_ACCESS_IFETCH,
+    CACHE_ACCESS_READ,
+    CACHE_ACCESS_WRITE,
+    NR_CACHE_ACCESS_TYPE
+} CacheAccessType;
+
+typedef struct CacheSweep CacheSweep;
+
+/* 统计结果按行交给调用者输出，行末不带换行符 */
+typedef void (*CacheReportFn)(const char *line);
+
+/* 按配置字符串创建缓存模拟器，配置有误时返回 NULL；nr_threads 为模拟多个配置时使用的线程数 */
+CacheSweep *cachesim_create(const char *configs, int nr_threads);
+
+/* 向所有配置送入一次访存 */
+void cachesim_access(CacheSweep *sweep, uint64_t addr, int len, CacheAccessType type);
+
+/* 逐行输出各配置的统计结果，insts 为期间执行的指令数，用于计算 MPKI */
+void cachesim_report(CacheSweep *sweep, uint64_t insts, CacheReportFn out);
+
+void cachesim_destroy(CacheSweep *sweep);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
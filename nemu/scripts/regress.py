@@ -0,0 +1,307 @@
+"""
+并行回归测试脚本：按清单在 NEMU 与 NPC 上并行运行测试镜像。
+
+清单为 JSON 文件，形如
+    {
+      "defaults": {"timeout": 60, "targets": ["nemu", "npc"]},
+      "tests": [
+        {"img": "am-kernels/tests/cpu-tests/build/*-riscv32e-npc.bin"},
+        {"name": "coremark", "img": "...", "elf": "...", "timeout": 600,
+         "targets": ["npc"], "env": {"NPC_CONFIG_DEVICE": "on"}}
+      ]
+    }
+img 支持通配符，相对路径以清单所在目录为基准；elf 缺省为 img 将扩展名换成 .elf。
+每个测试在输出目录下拥有独立的工作目录，各类跟踪日志与波形互不干扰。
+失败的测试先按 --retries 重试，仍失败时再开启 itrace / difftest 重跑一次以便定位。
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import signal
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor, as_completed
+from dataclasses import dataclass, field
+from xml.sax.saxutils import escape, quoteattr
+
+ANSI_RE = re.compile(r"\x1b\[[0-9;]*m")
+# NEMU: "nemu: HIT GOOD TRAP at pc = ..."；NPC: "仿真: HIT GOOD TRAP at pc = ..."
+TRAP_RE = re.compile(r"(HIT GOOD TRAP|HIT BAD TRAP|ABORT) at pc = (0x[0-9a-fA-F]+)")
+NPC_RET_RE = re.compile(r"结果: (\d+)")
+# XML 1.0 不允许出现的控制字符
+XML_INVALID_RE = re.compile(r"[\x00-\x08\x0b\x0c\x0e-\x1f]")
+# 写入 JUnit 的日志只保留末尾这么多字符
+JUNIT_LOG_LIMIT = 64 * 1024
+
+WORKBENCH = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+NEMU_HOME = os.environ.get("NEMU_HOME", os.path.join(WORKBENCH, "nemu"))
+NPC_HOME = os.environ.get("NPC_HOME", os.path.join(WORKBENCH, "npc"))
+
+
+@dataclass
+class Test:
+    name: str
+    img: str
+    elf: str
+    target: str
+    timeout: float
+    env: dict[str, str] = field(default_factory=dict)
+
+
+@dataclass
+class Result:
+    test: Test
+    status: str          # pass / fail / timeout / error
+    reason: str
+    time: float
+    attempts: int
+    log: str
+    debug_log: str = ""
+
+
+def load_manifest(path: str, targets: list[str] | None) -> list[Test]:
+    with open(path, "r") as f:
+        manifest = json.load(f)
+    base = os.path.dirname(os.path.abspath(path))
+    defaults = manifest.get("defaults", {})
+    tests = []
+    for entry in manifest["tests"]:
+        pattern = os.path.join(base, entry["img"])
+        imgs = sorted(glob.glob(pattern))
+        if not imgs:
+            print(f"[regress] 清单项 {entry['img']} 没有匹配的镜像", file=sys.stderr)
+            continue
+        for img in imgs:
+            name = entry.get("name") if len(imgs) == 1 and "name" in entry else \
+                os.path.splitext(os.path.basename(img))[0]
+            elf = os.path.join(base, entry["elf"]) if "elf" in entry else \
+                os.path.splitext(img)[0] + ".elf"
+            env = {**defaults.get("env", {}), **entry.get("env", {})}
+            for target in entry.get("targets", defaults.get("targets", ["nemu", "npc"])):
+                if targets and target not in targets:
+                    continue
+                tests.append(Test(name, img, elf, target,
+                                  float(entry.get("timeout", defaults.get("timeout", 60))),
+                                  env))
+    # 同一目标上重名的测试依次加上 -2、-3 等后缀，使其拥有各自的工作目录
+    seen: dict[tuple[str, str], int] = {}
+    for test in tests:
+        key = (test.target, test.name)
+        seen[key] = seen.get(key, 0) + 1
+        if seen[key] > 1:
+            test.name = f"{test.name}-{seen[key]}"
+    return tests
+
+
+def nemu_command(test: Test, workdir: str, debug: bool, args) -> tuple[list[str], dict]:
+    cmd = [args.nemu, "-b", "-l", os.path.join(workdir, "nemu-log.txt")]
+    if os.path.exists(test.elf):
+        cmd += ["-e", test.elf]
+    # NEMU 的 itrace 在编译期开启，重跑时只能额外接上 DiffTest 的 REF
+    if debug and args.nemu_ref:
+        cmd += ["-d", args.nemu_ref]
+    return cmd + [test.img], {}
+
+
+def npc_command(test: Test, workdir: str, debug: bool, port: int, args) -> tuple[list[str], dict]:
+    env = {
+        "NPC_BIN_PATH": test.img,
+        "NPC_SDB_ENABLED": "false",
+        "NPC_CONFIG_ELF_FILE_PATH": test.elf,
+        "NPC_CONFIG_DIFFTEST_PORT": str(port),
+        "NPC_CONFIG_DIFFTEST_SO_FILE_PATH": args.npc_ref,
+        "NPC_CONFIG_DEVICE": "off",
+        "NPC_CONFIG_WAVE": "off",
+        "NPC_CONFIG_DEBUG_OUTPUT": "off",
+        "NPC_CONFIG_PROFILE": "off",
+    }
+    for trace in ("ITRACE", "MTRACE", "FTRACE", "DTRACE", "ETRACE"):
+        env[f"NPC_CONFIG_{trace}"] = "off"
+        env[f"NPC_CONFIG_{trace}_OUT_FILE_PATH"] = os.path.join(workdir, f"{trace.lower()}.log")
+    env["NPC_CONFIG_WAVE_FILE_PATH"] = os.path.join(workdir, "sim.fst")
+    env["NPC_CONFIG_DIFFTEST"] = "off"
+    env.update(test.env)
+    if debug:
+        env["NPC_CONFIG_ITRACE"] = "on"
+        env["NPC_CONFIG_DIFFTEST"] = "on"
+    return [args.npc], env
+
+
+def judge(target: str, returncode: int, output: str) -> tuple[str, str]:
+    """根据输出中的 trap 信息与退出码判定测试结果。"""
+    output = ANSI_RE.sub("", output)
+    m = TRAP_RE.findall(output)
+    if m:
+        trap, pc = m[-1]
+        if trap == "HIT GOOD TRAP" and returncode == 0:
+            return "pass", ""
+        if trap == "HIT BAD TRAP":
+            ret = NPC_RET_RE.findall(output) if target == "npc" else []
+            return "fail", f"HIT BAD TRAP at pc = {pc}" + (f", halt_ret = {ret[-1]}" if ret else "")
+        if trap == "ABORT":
+            return "fail", f"ABORT at pc = {pc}"
+        return "fail", f"{trap} at pc = {pc}，但退出码为 {returncode}"
+    if returncode < 0:
+        return "error", f"被信号 {signal.Signals(-returncode).name} 终止"
+    return "error", f"未找到 trap 信息，退出码为 {returncode}"
+
+
+def run_once(test: Test, workdir: str, debug: bool, port: int, args) -> tuple[str, str, str]:
+    os.makedirs(workdir, exist_ok=True)
+    if test.target == "nemu":
+        cmd, extra = nemu_command(test, workdir, debug, args)
+    else:
+        cmd, extra = npc_command(test, workdir, debug, port, args)
+    env = {**os.environ, **extra}
+    log = os.path.join(workdir, "output.txt")
+    with open(log, "w") as out:
+        # 独立进程组，超时时连同子进程一起结束
+        proc = subprocess.Popen(cmd, cwd=workdir, env=env, stdin=subprocess.DEVNULL,
+                                stdout=out, stderr=subprocess.STDOUT, start_new_session=True)
+        try:
+            proc.wait(timeout=test.timeout)
+        except subprocess.TimeoutExpired:
+            os.killpg(proc.pid, signal.SIGKILL)
+            proc.wait()
+            return "timeout", f"超过 {test.timeout:g} 秒未结束", log
+    with open(log, "r", errors="replace") as f:
+        status, reason = judge(test.target, proc.returncode, f.read())
+    return status, reason, log
+
+
+def run_test(index: int, test: Test, args) -> Result:
+    workdir = os.path.join(args.out_dir, test.target, test.name)
+    port = args.port_base + index
+    start = time.monotonic()
+    attempts = 0
+    while True:
+        attempts += 1
+        status, reason, log = run_once(test, workdir, False, port, args)
+        if status == "pass" or attempts > args.retries:
+            break
+    result = Result(test, status, reason, time.monotonic() - start, attempts, log)
+    if status != "pass" and args.debug_rerun:
+        _, _, result.debug_log = run_once(test, os.path.join(workdir, "debug"), True, port, args)
+    return result
+
+
+def write_json(path: str, results: list[Result], elapsed: float) -> None:
+    summary = {
+        "elapsed": elapsed,
+        "total": len(results),
+        "passed": sum(r.status == "pass" for r in results),
+        "tests": [{
+            "name": r.test.name, "target": r.test.target, "img": r.test.img,
+            "status": r.status, "reason": r.reason, "time": round(r.time, 3),
+            "attempts": r.attempts, "log": r.log, "debug_log": r.debug_log,
+        } for r in results],
+    }
+    with open(path, "w") as f:
+        json.dump(summary, f, indent=2, ensure_ascii=False)
+
+
+def read_log(path: str) -> str:
+    """读取日志内容供 JUnit 使用，过长时只保留末尾部分。"""
+    if not path or not os.path.exists(path):
+        return ""
+    with open(path, "r", errors="replace") as f:
+        text = f.read()
+    if len(text) > JUNIT_LOG_LIMIT:
+        text = f"... (省略前 {len(text) - JUNIT_LOG_LIMIT} 个字符，完整日志见 {path})\n" + \
+            text[-JUNIT_LOG_LIMIT:]
+    return XML_INVALID_RE.sub("", ANSI_RE.sub("", text))
+
+
+def write_junit(path: str, results: list[Result], elapsed: float) -> None:
+    lines = ['<?xml version="1.0" encoding="UTF-8"?>', '<testsuites>']
+    for target in sorted({r.test.target for r in results}):
+        rs = [r for r in results if r.test.target == target]
+        failures = sum(r.status == "fail" for r in rs)
+        errors = sum(r.status in ("timeout", "error") for r in rs)
+        lines.append(f'<testsuite name={quoteattr(target)} tests="{len(rs)}" '
+                     f'failures="{failures}" errors="{errors}" time="{elapsed:.3f}">')
+        for r in rs:
+            lines.append(f'  <testcase classname={quoteattr(target)} name={quoteattr(r.test.name)} '
+                         f'time="{r.time:.3f}">')
+            if r.status == "fail":
+                lines.append(f'    <failure message={quoteattr(r.reason)}/>')
+            elif r.status != "pass":
+                lines.append(f'    <error message={quoteattr(r.reason)}/>')
+            if r.status != "pass":
+                out = read_log(r.log)
+                if r.debug_log:
+                    out += "\n----- 调试重跑 -----\n" + read_log(r.debug_log)
+                lines.append(f'    <system-out>{escape(out)}</system-out>')
+            lines.append('  </testcase>')
+        lines.append('</testsuite>')
+    lines.append('</testsuites>')
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="NEMU / NPC 并行回归测试")
+    parser.add_argument("manifest", help="测试清单 (JSON)")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="并行任务数")
+    parser.add_argument("-t", "--target", action="append", choices=["nemu", "npc"],
+                        help="只运行指定目标上的测试，可多次指定")
+    parser.add_argument("-o", "--out-dir", default="build/regress", help="输出目录")
+    parser.add_argument("--retries", type=int, default=0, help="失败测试的重试次数")
+    parser.add_argument("--no-debug-rerun", dest="debug_rerun", action="store_false",
+                        help="失败后不再开启 itrace / difftest 重跑")
+    parser.add_argument("--json", help="JSON 汇总输出路径，缺省为 <out-dir>/summary.json")
+    parser.add_argument("--junit", help="JUnit XML 汇总输出路径，缺省为 <out-dir>/junit.xml")
+    parser.add_argument("--nemu", default=os.path.join(NEMU_HOME, "build", "riscv32-nemu-interpreter"))
+    parser.add_argument("--npc", default=os.path.join(NPC_HOME, "build", "ProcessorCore"))
+    parser.add_argument("--nemu-ref", help="NEMU 失败重跑时使用的 DiffTest REF")
+    parser.add_argument("--npc-ref", default=os.path.join(NEMU_HOME, "build", "riscv32-nemu-interpreter-so"),
+                        help="NPC 失败重跑时使用的 DiffTest REF")
+    parser.add_argument("--port-base", type=int, default=20000, help="DiffTest 端口的起始值")
+    args = parser.parse_args()
+
+    # 每个测试在各自的工作目录下运行，路径一律转为绝对路径
+    args.out_dir = os.path.abspath(args.out_dir)
+    args.nemu, args.npc = os.path.abspath(args.nemu), os.path.abspath(args.npc)
+    if args.nemu_ref:
+        args.nemu_ref = os.path.abspath(args.nemu_ref)
+    args.npc_ref = os.path.abspath(args.npc_ref)
+    tests = load_manifest(args.manifest, args.target)
+    if not tests:
+        print("[regress] 清单中没有可运行的测试", file=sys.stderr)
+        return 1
+    for target, binary in (("nemu", args.nemu), ("npc", args.npc)):
+        if any(t.target == target for t in tests) and not os.access(binary, os.X_OK):
+            print(f"[regress] 找不到 {target} 的可执行文件 {binary}", file=sys.stderr)
+            return 1
+
+    print(f"[regress] 共 {len(tests)} 个测试，{args.jobs} 路并行")
+    start = time.monotonic()
+    results = []
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        futures = [pool.submit(run_test, i, t, args) for i, t in enumerate(tests)]
+        for future in as_completed(futures):
+            r = future.result()
+            results.append(r)
+            mark = "PASS" if r.status == "pass" else r.status.upper()
+            print(f"[{len(results):>4}/{len(tests)}] {mark:<7} {r.test.target:<4} "
+                  f"{r.test.name} ({r.time:.1f}s){': ' + r.reason if r.reason else ''}", flush=True)
+    elapsed = time.monotonic() - start
+
+    results.sort(key=lambda r: (r.test.target, r.test.name))
+    write_json(args.json or os.path.join(args.out_dir, "summary.json"), results, elapsed)
+    write_junit(args.junit or os.path.join(args.out_dir, "junit.xml"), results, elapsed)
+
+    failed = [r for r in results if r.status != "pass"]
+    print(f"[regress] {len(results) - len(failed)}/{len(results)} 通过，用时 {elapsed:.1f}s")
+    for r in failed:
+        print(f"  {r.test.target:<4} {r.test.name}: {r.reason}")
+        print(f"       日志: {r.log}" + (f"\n       调试日志: {r.debug_log}" if r.debug_log else ""))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,203 @@
+"""
+SimPoint 采样仿真的辅助脚本。
+
+pick:     读取 NEMU 输出的 BBV（.bb 格式），用 k-means 聚类选出代表性区间，
+          输出 SimPoint 格式的 simpoints 与 weights 文件。
+estimate: 读取 NPC 在各检查点上测得的结果（JSON lines），按权重估算整个程序的 IPC。
+"""
+
+import argparse
+import json
+import math
+import random
+import sys
+
+
+def load_bbv(path: str) -> tuple[list[dict[int, float]], list[int]]:
+    """读取 BBV，返回归一化后的向量及各区间的指令数。"""
+    vectors, insts = [], []
+    with open(path, "r") as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith("T"):
+                continue
+            vec = {}
+            for item in line[1:].split():
+                _, bb, count = item.split(":")
+                vec[int(bb)] = vec.get(int(bb), 0) + int(count)
+            total = sum(vec.values())
+            if total == 0:
+                continue
+            vectors.append({bb: count / total for bb, count in vec.items()})
+            insts.append(total)
+    return vectors, insts
+
+
+def project(vectors: list[dict[int, float]], dims: int, seed: int) -> list[list[float]]:
+    """随机投影降维，与 SimPoint 的做法相同。"""
+    rng = random.Random(seed)
+    matrix: dict[int, list[float]] = {}
+    points = []
+    for vec in vectors:
+        p = [0.0] * dims
+        for bb, v in vec.items():
+            if bb not in matrix:
+                matrix[bb] = [rng.uniform(-1, 1) for _ in range(dims)]
+            row = matrix[bb]
+            for d in range(dims):
+                p[d] += v * row[d]
+        points.append(p)
+    return points
+
+
+def dist2(a: list[float], b: list[float]) -> float:
+    return sum((x - y) ** 2 for x, y in zip(a, b))
+
+
+def kmeans(points: list[list[float]], weights: list[int], k: int, seed: int,
+           iters: int = 100) -> tuple[list[int], list[list[float]]]:
+    rng = random.Random(seed)
+    # k-means++ 初始化
+    centers = [points[rng.randrange(len(points))]]
+    while len(centers) < k:
+        d = [min(dist2(p, c) for c in centers) for p in points]
+        total = sum(d)
+        if total == 0:
+            break
+        r = rng.uniform(0, total)
+        for i, di in enumerate(d):
+            r -= di
+            if r <= 0:
+                centers.append(points[i])
+                break
+    labels = [0] * len(points)
+    for _ in range(iters):
+        new_labels = [min(range(len(centers)), key=lambda c: dist2(p, centers[c])) for p in points]
+        dims = len(points[0])
+        sums = [[0.0] * dims for _ in centers]
+        totals = [0] * len(centers)
+        for p, w, c in zip(points, weights, new_labels):
+            totals[c] += w
+            for d in range(dims):
+                sums[c][d] += p[d] * w
+        centers = [[s / totals[c] for s in sums[c]] if totals[c] else centers[c]
+                   for c in range(len(centers))]
+        if new_labels == labels:
+            break
+        labels = new_labels
+    return labels, centers
+
+
+def bic(points: list[list[float]], labels: list[int], centers: list[list[float]]) -> float:
+    """按 x-means 的方式计算聚类结果的 BIC 分数。"""
+    r, k, dims = len(points), len(centers), len(points[0])
+    if r <= k:
+        return -math.inf
+    variance = sum(dist2(p, centers[c]) for p, c in zip(points, labels)) / (r - k)
+    variance = max(variance, 1e-12)
+    likelihood = 0.0
+    for c in range(k):
+        rc = labels.count(c)
+        if rc == 0:
+            continue
+        likelihood += (rc * math.log(rc) - rc * math.log(r)
+                       - rc / 2 * math.log(2 * math.pi) - rc * dims / 2 * math.log(variance)
+                       - (rc - k) / 2)
+    params = (k - 1) + k * dims + 1
+    return likelihood - params / 2 * math.log(r)
+
+
+def pick(args: argparse.Namespace) -> None:
+    vectors, insts = load_bbv(args.bbv)
+    if not vectors:
+        print(f"No interval found in {args.bbv}")
+        sys.exit(1)
+    points = project(vectors, args.dims, args.seed)
+
+    results = []
+    for k in range(1, min(args.max_k, len(points)) + 1):
+        labels, centers = kmeans(points, insts, k, args.seed)
+        results.append((k, bic(points, labels, centers), labels, centers))
+        print(f"k = {k:2d}, BIC = {results[-1][1]:.2f}")
+
+    # 与 SimPoint 相同，选 BIC 达到其变化范围 90% 的最小 k
+    scores = [s for _, s, _, _ in results if s != -math.inf]
+    if not scores:
+        # 区间太少（如只有一个区间）时 BIC 无意义，全部归为一类，权重为 1
+        k, _, labels, centers = results[0]
+    else:
+        low, high = min(scores), max(scores)
+        k, _, labels, centers = next(r for r in results if r[1] >= low + (high - low) * args.bic_threshold)
+
+    total = sum(insts)
+    with open(args.simpoints, "w") as fs, open(args.weights, "w") as fw:
+        for c in range(len(centers)):
+            members = [i for i, label in enumerate(labels) if label == c]
+            if not members:
+                continue
+            rep = min(members, key=lambda i: dist2(points[i], centers[c]))
+            weight = sum(insts[i] for i in members) / total
+            fs.write(f"{rep} {c}\n")
+            fw.write(f"{weight:.6f} {c}\n")
+            print(f"cluster {c}: interval {rep}, weight {weight:.4f}, {len(members)} intervals")
+    print(f"{k} simpoints written to {args.simpoints}, weights to {args.weights}")
+
+
+def estimate(args: argparse.Namespace) -> None:
+    interval_cluster = {}
+    with open(args.simpoints, "r") as f:
+        for line in f:
+            interval, cluster = line.split()
+            interval_cluster[int(interval)] = int(cluster)
+    cluster_weight = {}
+    with open(args.weights, "r") as f:
+        for line in f:
+            weight, cluster = line.split()
+            cluster_weight[int(cluster)] = float(weight)
+
+    cpi, covered = 0.0, 0.0
+    with open(args.results, "r") as f:
+        for line in f:
+            result = json.loads(line)
+            cluster = interval_cluster.get(result["interval"])
+            if cluster is None or result["insts"] == 0:
+                continue
+            weight = cluster_weight[cluster]
+            cpi += weight * result["cycles"] / result["insts"]
+            covered += weight
+            print(f"interval {result['interval']}: weight {weight:.4f}, "
+                  f"IPC {result['insts'] / result['cycles']:.4f}")
+    if covered == 0:
+        print("No result matches the simpoints")
+        sys.exit(1)
+    # 缺失的检查点按已有的权重重新归一化
+    cpi /= covered
+    print(f"estimated CPI = {cpi:.4f}, IPC = {1 / cpi:.4f} ({covered * 100:.1f}% of weight covered)")
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description="SimPoint helpers for NEMU and NPC")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p = sub.add_parser("pick", help="pick representative intervals from BBVs")
+    p.add_argument("bbv", help="basic block vectors written by NEMU")
+    p.add_argument("--simpoints", default="build/simpoints")
+    p.add_argument("--weights", default="build/weights")
+    p.add_argument("--max-k", type=int, default=30)
+    p.add_argument("--dims", type=int, default=15)
+    p.add_argument("--seed", type=int, default=42)
+    p.add_argument("--bic-threshold", type=float, default=0.9)
+    p.set_defaults(func=pick)
+
+    p = sub.add_parser("estimate", help="estimate the whole program IPC")
+    p.add_argument("results", help="JSON lines written by NPC, one per checkpoint")
+    p.add_argument("--simpoints", default="build/simpoints")
+    p.add_argument("--weights", default="build/weights")
+    p.set_defaults(func=estimate)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,375 @@
+#include <common.h>
+#include <cpu/bpred.h>
+
+#ifdef CONFIG_BPRED
+
+#define BPRED_PC_TABLE_SIZE 65536
+#define BPRED_TABLE_ROWS 30
+
+#define BIMODAL_BITS 12
+#define GSHARE_BITS 12
+#define BTB_BITS 9
+#define RAS_DEPTH 16
+
+#define TAGE_NR_TABLES 4
+#define TAGE_BASE_BITS 12
+#define TAGE_TABLE_BITS 10
+#define TAGE_TAG_BITS 8
+#define TAGE_USEFUL_RESET_PERIOD (256 * 1024)
+
+typedef enum { PRED_SKIP, PRED_CORRECT, PRED_MISS } PredResult;
+
+/*
+ * 预测器接口：每条控制转移指令执行后调用一次 access，由其自行完成预测与更新，
+ * 返回本次是否参与评估以及预测是否正确。新增预测器只需实现 access 并加入 predictors 表。
+ */
+typedef struct {
+    const char *name;
+    PredResult (*access)(const BranchInfo *b);
+    uint64_t lookups;
+    uint64_t misses;
+} BranchPredictor;
+
+typedef struct {
+    vaddr_t pc;
+    BranchKind kind;
+    uint64_t count;
+    uint64_t taken;
+    uint64_t misses[8]; // 以预测器在 predictors 表中的下标为索引
+} BranchEntry;
+
+static const char *kind_names[NR_BRANCH_KIND] = { "cond", "jump", "call", "ret", "indirect" };
+
+extern uint64_t g_nr_guest_inst;
+
+static inline uint32_t pc_index(vaddr_t pc, int bits) {
+    return (pc >> 2) & ((1u << bits) - 1);
+}
+
+/* 饱和计数器，取值范围为 [0, max] */
+static inline void counter_update(uint8_t *c, bool taken, uint8_t max) {
+    if (taken) {
+        if (*c < max) (*c)++;
+    } else {
+        if (*c > 0) (*c)--;
+    }
+}
+
+static inline PredResult pred_result(bool pred, bool taken) {
+    return pred == taken ? PRED_CORRECT : PRED_MISS;
+}
+
+// ----- 静态预测：向后跳转预测为跳转，向前跳转预测为不跳转 (BTFN) -----
+
+static PredResult static_access(const BranchInfo *b) {
+    if (b->kind != BRANCH_COND) {
+        return PRED_SKIP;
+    }
+    return pred_result(b->target < b->pc, b->taken);
+}
+
+// ----- bimodal：以 PC 为索引的 2 位计数器 -----
+
+static uint8_t bimodal_table[1 << BIMODAL_BITS] = {};
+
+static PredResult bimodal_access(const BranchInfo *b) {
+    uint8_t *c;
+    bool pred;
+
+    if (b->kind != BRANCH_COND) {
+        return PRED_SKIP;
+    }
+    c = &bimodal_table[pc_index(b->pc, BIMODAL_BITS)];
+    pred = *c >= 2;
+    counter_update(c, b->taken, 3);
+    return pred_result(pred, b->taken);
+}
+
+// ----- gshare：PC 与全局历史异或后索引 2 位计数器 -----
+
+static uint8_t gshare_table[1 << GSHARE_BITS] = {};
+static uint32_t gshare_history = 0;
+
+static PredResult gshare_access(const BranchInfo *b) {
+    uint8_t *c;
+    bool pred;
+
+    if (b->kind != BRANCH_COND) {
+        return PRED_SKIP;
+    }
+    c = &gshare_table[(pc_index(b->pc, GSHARE_BITS) ^ gshare_history) & ((1u << GSHARE_BITS) - 1)];
+    pred = *c >= 2;
+    counter_update(c, b->taken, 3);
+    gshare_history = ((gshare_history << 1) | b->taken) & ((1u << GSHARE_BITS) - 1);
+    return pred_result(pred, b->taken);
+}
+
+// ----- TAGE-lite：bimodal 基础预测器加 4 个以几何级数长度的全局历史索引的带标签表 -----
+
+typedef struct {
+    bool valid;     // 未分配的表项不参与标签匹配
+    uint8_t ctr;    // 3 位计数器，>= 4 表示预测跳转
+    uint8_t tag;
+    uint8_t useful; // 2 位
+} TageEntry;
+
+static const int tage_hist_len[TAGE_NR_TABLES] = { 5, 11, 22, 44 };
+static uint8_t tage_base[1 << TAGE_BASE_BITS] = {};
+static TageEntry tage_tables[TAGE_NR_TABLES][1 << TAGE_TABLE_BITS] = {};
+static uint64_t tage_history = 0;
+static uint64_t tage_nr_branches = 0;
+
+/* 将最近 len 位全局历史折叠为 bits 位 */
+static inline uint32_t tage_fold(int len, int bits) {
+    uint64_t h = len >= 64 ? tage_history : tage_history & ((1ull << len) - 1);
+    uint32_t r = 0;
+
+    while (h) {
+        r ^= h & ((1u << bits) - 1);
+        h >>= bits;
+    }
+    return r;
+}
+
+static inline uint32_t tage_index(int t, vaddr_t pc) {
+    return ((pc >> 2) ^ (pc >> (2 + TAGE_TABLE_BITS)) ^ tage_fold(tage_hist_len[t], TAGE_TABLE_BITS)) &
+        ((1u << TAGE_TABLE_BITS) - 1);
+}
+
+static inline uint8_t tage_tag(int t, vaddr_t pc) {
+    return ((pc >> 2) ^ (tage_fold(tage_hist_len[t], TAGE_TAG_BITS) << 1) ^ t) & ((1u << TAGE_TAG_BITS) - 1);
+}
+
+static PredResult tage_access(const BranchInfo *b) {
+    TageEntry *hit[TAGE_NR_TABLES] = {};
+    uint8_t *base;
+    int provider = -1, alt = -1, t;
+    bool pred, alt_pred;
+
+    if (b->kind != BRANCH_COND) {
+        return PRED_SKIP;
+    }
+
+    base = &tage_base[pc_index(b->pc, TAGE_BASE_BITS)];
+    for (t = 0; t < TAGE_NR_TABLES; t++) {
+        TageEntry *e = &tage_tables[t][tage_index(t, b->pc)];
+        if (e->valid && e->tag == tage_tag(t, b->pc)) {
+            hit[t] = e;
+            alt = provider;
+            provider = t;
+        }
+    }
+    alt_pred = alt >= 0 ? hit[alt]->ctr >= 4 : *base >= 2;
+    pred = provider >= 0 ? hit[provider]->ctr >= 4 : alt_pred;
+
+    // 更新：提供预测的表项训练计数器，与备选预测不同时调整 useful
+    if (provider >= 0) {
+        TageEntry *e = hit[provider];
+        if (pred != alt_pred) {
+            counter_update(&e->useful, pred == b->taken, 3);
+        }
+        counter_update(&e->ctr, b->taken, 7);
+        if (alt < 0) {
+            counter_update(base, b->taken, 3);
+        }
+    } else {
+        counter_update(base, b->taken, 3);
+    }
+
+    // 预测错误时在更长历史的表中分配新表项，没有空位则使这些表项老化
+    if (pred != b->taken && provider < TAGE_NR_TABLES - 1) {
+        bool allocated = false;
+        for (t = provider + 1; t < TAGE_NR_TABLES; t++) {
+            TageEntry *e = &tage_tables[t][tage_index(t, b->pc)];
+            if (e->useful == 0) {
+                e->valid = true;
+                e->tag = tage_tag(t, b->pc);
+                e->ctr = b->taken ? 4 : 3;
+                allocated = true;
+                break;
+            }
+        }
+        if (!allocated) {
+            for (t = provider + 1; t < TAGE_NR_TABLES; t++) {
+                TageEntry *e = &tage_tables[t][tage_index(t, b->pc)];
+                if (e->useful > 0) e->useful--;
+            }
+        }
+    }
+
+    if (++tage_nr_branches % TAGE_USEFUL_RESET_PERIOD == 0) {
+        for (t = 0; t < TAGE_NR_TABLES; t++) {
+            for (size_t i = 0; i < (1u << TAGE_TABLE_BITS); i++) {
+                tage_tables[t][i].useful >>= 1;
+            }
+        }
+    }
+
+    tage_history = (tage_history << 1) | b->taken;
+    return pred_result(pred, b->taken);
+}
+
+// ----- BTB：直接映射的目的地址缓存，评估除返回外所有实际跳转的目的地址 -----
+
+typedef struct {
+    bool valid;
+    vaddr_t pc;
+    vaddr_t target;
+} BtbEntry;
+
+static BtbEntry btb_table[1 << BTB_BITS] = {};
+
+static PredResult btb_access(const BranchInfo *b) {
+    BtbEntry *e;
+    bool correct;
+
+    if (b->kind == BRANCH_RET || !b->taken) {
+        return PRED_SKIP;
+    }
+    e = &btb_table[pc_index(b->pc, BTB_BITS)];
+    correct = e->valid && e->pc == b->pc && e->target == b->target;
+    e->valid = true;
+    e->pc = b->pc;
+    e->target = b->target;
+    return correct ? PRED_CORRECT : PRED_MISS;
+}
+
+// ----- RAS：返回地址栈，栈满时覆盖最旧的表项 -----
+
+static vaddr_t ras_stack[RAS_DEPTH] = {};
+static int ras_top = 0;
+static int ras_size = 0;
+
+static PredResult ras_access(const BranchInfo *b) {
+    vaddr_t pred;
+
+    if (b->kind == BRANCH_CALL) {
+        ras_top = (ras_top + 1) % RAS_DEPTH;
+        ras_stack[ras_top] = b->fallthrough;
+        if (ras_size < RAS_DEPTH) ras_size++;
+        return PRED_SKIP;
+    }
+    if (b->kind != BRANCH_RET) {
+        return PRED_SKIP;
+    }
+    if (ras_size == 0) {
+        return PRED_MISS;
+    }
+    pred = ras_stack[ras_top];
+    ras_top = (ras_top + RAS_DEPTH - 1) % RAS_DEPTH;
+    ras_size--;
+    return pred == b->target ? PRED_CORRECT : PRED_MISS;
+}
+
+static BranchPredictor predictors[] = {
+    { .name = "static",   .access = static_access },
+    { .name = "bimodal",  .access = bimodal_access },
+    { .name = "gshare",   .access = gshare_access },
+    { .name = "tage-lite", .access = tage_access },
+    { .name = "btb",      .access = btb_access },
+    { .name = "ras",      .access = ras_access },
+};
+
+#define NR_PREDICTORS ARRLEN(predictors)
+
+_Static_assert(sizeof(predictors) / sizeof(predictors[0]) <= 8, "BranchEntry.misses is too small");
+
+static BranchEntry pc_table[BPRED_PC_TABLE_SIZE] = {};
+static size_t nr_pcs = 0;
+static uint64_t nr_dropped = 0;
+static uint64_t kind_count[NR_BRANCH_KIND] = {};
+
+/* count 为 0 的表项视为空闲，表满时返回 NULL */
+static BranchEntry *find_pc(vaddr_t pc) {
+    uint32_t h = (uint32_t) ((uint64_t) pc * 0x9e3779b97f4a7c15ull >> 32);
+    size_t i;
+
+    for (i = 0; i < BPRED_PC_TABLE_SIZE; i++) {
+        BranchEntry *e = &pc_table[(h + i) % BPRED_PC_TABLE_SIZE];
+        if (e->count == 0) {
+            e->pc = pc;
+            nr_pcs++;
+            return e;
+        }
+        if (e->pc == pc) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+void bpred_branch(const BranchInfo *b) {
+    BranchEntry *e = find_pc(b->pc);
+    size_t i;
+
+    kind_count[b->kind]++;
+    if (e) {
+        e->kind = b->kind;
+        e->count++;
+        e->taken += b->taken;
+    } else {
+        nr_dropped++;
+    }
+    for (i = 0; i < NR_PREDICTORS; i++) {
+        PredResult r = predictors[i].access(b);
+        if (r == PRED_SKIP) {
+            continue;
+        }
+        predictors[i].lookups++;
+        if (r == PRED_MISS) {
+            predictors[i].misses++;
+            if (e) e->misses[i]++;
+        }
+    }
+}
+
+static int cmp_pc(const void *a, const void *b) {
+    const BranchEntry *x = a, *y = b;
+    return x->count < y->count ? 1 : x->count > y->count ? -1 : (x->pc > y->pc) - (x->pc < y->pc);
+}
+
+void bpred_dump(void) {
+    static BranchEntry pcs[BPRED_PC_TABLE_SIZE];
+    char line[256];
+    size_t i, j, nr;
+    int n;
+
+    if (g_nr_guest_inst == 0) {
+        return;
+    }
+
+    Log("control transfers: %" PRIu64 " cond, %" PRIu64 " jump, %" PRIu64 " call, %" PRIu64 " ret, %" PRIu64 " indirect",
+        kind_count[BRANCH_COND], kind_count[BRANCH_JUMP], kind_count[BRANCH_CALL],
+        kind_count[BRANCH_RET], kind_count[BRANCH_INDIRECT]);
+    Log("%-10s %14s %14s %9s %9s", "predictor", "lookups", "misses", "accuracy", "MPKI");
+    for (i = 0; i < NR_PREDICTORS; i++) {
+        BranchPredictor *p = &predictors[i];
+        Log("%-10s %14" PRIu64 " %14" PRIu64 " %8.2f%% %9.3f", p->name, p->lookups, p->misses,
+            p->lookups ? (p->lookups - p->misses) * 100.0 / p->lookups : 0,
+            p->misses * 1000.0 / g_nr_guest_inst);
+    }
+
+    for (i = 0, nr = 0; i < BPRED_PC_TABLE_SIZE; i++) {
+        if (pc_table[i].count != 0) {
+            pcs[nr++] = pc_table[i];
+        }
+    }
+    qsort(pcs, nr_pcs, sizeof(BranchEntry), cmp_pc);
+
+    Log("hot branches: %zu PCs, %" PRIu64 " dropped", nr_pcs, nr_dropped);
+    n = snprintf(line, sizeof(line), "%-10s %-8s %12s %7s", "pc", "kind", "count", "taken");
+    for (j = 0; j < NR_PREDICTORS; j++) {
+        n += snprintf(line + n, sizeof(line) - n, " %10s", predictors[j].name);
+    }
+    Log("%s", line);
+    for (i = 0; i < nr_pcs && i < BPRED_TABLE_ROWS; i++) {
+        n = snprintf(line, sizeof(line), FMT_WORD " %-8s %12" PRIu64 " %6.2f%%", pcs[i].pc,
+            kind_names[pcs[i].kind], pcs[i].count, pcs[i].taken * 100.0 / pcs[i].count);
+        for (j = 0; j < NR_PREDICTORS; j++) {
+            n += snprintf(line + n, sizeof(line) - n, " %10" PRIu64, pcs[i].misses[j]);
+        }
+        Log("%s", line);
+    }
+}
+
+#endif
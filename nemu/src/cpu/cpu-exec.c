@@ -16,6 +16,10 @@
 #include <cpu/cpu.h>
 #include <cpu/decode.h>
 #include <cpu/difftest.h>
+#include <cpu/inststat.h>
+#include <cpu/bpred.h>
+#include <cpu/simpoint.h>
+#include <memory/paddr.h>
 #include <locale.h>
 #include <utils.h>
 
@@ -34,8 +38,16 @@ static bool g_print_step = false;
 void device_update();
 
 static void trace_and_difftest(Decode *_this, vaddr_t dnpc) {
-#ifdef CONFIG_ITRACE_COND
-  if (ITRACE_COND) {
+#ifdef CONFIG_ITRACE
+  // 只有确实要写入日志或打印时才格式化并反汇编，iringbuf 中只保存原始指令
+  extern FILE* log_fp;
+  extern bool log_enable();
+  bool itrace_log = log_fp != NULL && log_enable() && (ITRACE_COND);
+  if (itrace_log || g_print_step) {
+    nemu_itrace_format(_this->logbuf, sizeof(_this->logbuf), _this->pc,
+        (uint8_t *)&_this->isa.inst, _this->snpc - _this->pc);
+  }
+  if (itrace_log) {
     log_write("%s\n", _this->logbuf);
   }
 #endif
@@ -99,51 +111,7 @@ static void exec_once(Decode *s, vaddr_t pc) {
   cpu.pc = s->dnpc;
   
 #ifdef CONFIG_ITRACE
-  void disassemble(char *str, int size, uint64_t pc, uint8_t *code, int nbyte);
-
-  char pbuf[128];
-  char *p = pbuf;
-  p += snprintf(p, sizeof(pbuf), "[itrace] " FMT_WORD ":", s->pc);
-  int ilen = s->snpc - s->pc;
-  int i;
-  uint8_t *inst = (uint8_t *)&s->isa.inst;
-#ifdef CONFIG_ISA_x86
-  for (i = 0; i < ilen; i ++) {
-#else
-  for (i = ilen - 1; i >= 0; i --) {
-#endif
-    p += snprintf(p, 4, " %02x", inst[i]);
-  }
-  int ilen_max = MUXDEF(CONFIG_ISA_x86, 8, 4);
-  int space_len = ilen_max - ilen;
-  if (space_len < 0) space_len = 0;
-  space_len = space_len * 3 + 1;
-  memset(p, ' ', space_len);
-  p += space_len;
-
-  disassemble(p, pbuf + sizeof(pbuf) - p,
-      MUXDEF(CONFIG_ISA_x86, s->snpc, s->pc), (uint8_t *)&s->isa.inst, ilen);
-
-  char cbuf[256];
-  bstring bbuf;
-  bool success;
-
-  snprintf(cbuf, sizeof(cbuf), "%s\n", pbuf);
-  bbuf = bfromcstr(cbuf);
-  if (blength(bbuf) > RingBuffer_available_space(nemu_iringbuf)) {
-    RingBuffer_discard(nemu_iringbuf, blength(bbuf));
-  }
-  for (;;) {
-    RingBuffer_puts(nemu_iringbuf, bbuf, &success);
-    if (success) {
-      break;
-    }
-    RingBuffer_discard(nemu_iringbuf, blength(bbuf));
-  }
-  bdestroy(bbuf);
-
-  memset(s->logbuf, 0, sizeof(s->logbuf));
-  strcpy(s->logbuf, pbuf);
+  nemu_iringbuf_record(s->pc, &s->isa.inst, s->snpc - s->pc);
 #endif
 }
 
@@ -153,6 +121,9 @@ static void execute(uint64_t n) {
     IFDEF(CONFIG_PC_OUTPUT, printf("PC is at 0x%08x\n", cpu.pc));
     exec_once(&s, cpu.pc);
     g_nr_guest_inst ++;
+    IFDEF(CONFIG_INSTSTAT, inststat_exec(&s));
+    IFDEF(CONFIG_SIMPOINT, if (g_nr_guest_inst % CONFIG_SIMPOINT_INTERVAL == 0) simpoint_interval_end());
+    IFDEF(CONFIG_SAMPLER, if (g_nr_guest_inst % CONFIG_SAMPLER_INTERVAL == 0) sampler_sample(cpu.pc));
     trace_and_difftest(&s, cpu.pc);
     if (nemu_state.state != NEMU_RUNNING) break;
     IFDEF(CONFIG_DEVICE, device_update());
@@ -170,9 +141,24 @@ static void statistic() {
   Log("total guest instructions = " NUMBERIC_FMT, g_nr_guest_inst);
   if (g_timer > 0) Log("simulation frequency = " NUMBERIC_FMT " inst/s", g_nr_guest_inst * 1000000 / g_timer);
   else Log("Finish running in less than 1 us and can not calculate the simulation frequency");
+  IFDEF(CONFIG_SAMPLER, sampler_dump());
+  IFDEF(CONFIG_INSTSTAT, inststat_dump());
+  IFDEF(CONFIG_SIMPOINT, simpoint_finish());
+  IFDEF(CONFIG_CACHESIM, paddr_cachesim_report(g_nr_guest_inst));
+  IFDEF(CONFIG_BPRED, bpred_dump());
+}
+
+// 将串口中尚未写出的客户程序输出写出，使其出现在 NEMU 自身的结束信息之前
+static void flush_guest_output() {
+#if defined(CONFIG_HAS_SERIAL) && !defined(CONFIG_TARGET_AM)
+  void serial_flush();
+  serial_flush();
+#endif
 }
 
 void assert_fail_msg() {
+  // assert() 随后调用 abort()，不会执行 atexit 注册的函数
+  flush_guest_output();
   isa_reg_display();
   statistic();
 }
@@ -187,6 +173,8 @@ void cpu_exec(uint64_t n) {
     default: nemu_state.state = NEMU_RUNNING;
   }
 
+  IFDEF(CONFIG_INSTSTAT, inststat_start(cpu.pc));
+
   uint64_t timer_start = get_time();
 
   execute(n);
@@ -194,6 +182,8 @@ void cpu_exec(uint64_t n) {
   uint64_t timer_end = get_time();
   g_timer += timer_end - timer_start;
 
+  if (nemu_state.state != NEMU_RUNNING) flush_guest_output();
+
   switch (nemu_state.state) {
     case NEMU_RUNNING: nemu_state.state = NEMU_STOP; break;
 
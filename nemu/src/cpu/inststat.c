@@ -0,0 +1,276 @@
+#include <common.h>
+#include <isa.h>
+#include <cpu/inststat.h>
+#include <cpu/simpoint.h>
+
+#ifdef CONFIG_INSTSTAT
+
+#define INSTSTAT_EDGE_TABLE_SIZE 131072
+#define INSTSTAT_TABLE_ROWS 30
+
+/* 基本块，以其首条指令的 PC 为键 */
+typedef struct {
+    vaddr_t pc;
+    uint32_t bytes;
+    uint64_t count;
+} BlockEntry;
+
+/* 基本块之间的控制流边 */
+typedef struct {
+    vaddr_t from;
+    vaddr_t to;
+    uint64_t count;
+} EdgeEntry;
+
+/* 链接器为 nemu_inststat 段自动生成的起止符号 */
+extern InstStat __start_nemu_inststat[];
+extern InstStat __stop_nemu_inststat[];
+
+extern uint64_t g_nr_guest_inst;
+
+bool inststat_block_end = false;
+uint64_t inststat_load_size[9] = {};
+uint64_t inststat_store_size[9] = {};
+
+static BlockEntry block_table[INSTSTAT_BLOCK_TABLE_SIZE] = {};
+static EdgeEntry edge_table[INSTSTAT_EDGE_TABLE_SIZE] = {};
+static size_t nr_blocks = 0;
+static size_t nr_edges = 0;
+static uint64_t nr_dropped = 0;
+static vaddr_t cur_block = 0;
+static uint64_t cur_block_start = 0;
+static bool started = false;
+
+static inline uint32_t hash_pc(vaddr_t pc) {
+    return (uint32_t) ((uint64_t) pc * 0x9e3779b97f4a7c15ull >> 32);
+}
+
+/* count 为 0 的表项视为空闲，表满时返回 NULL */
+static BlockEntry *find_block(vaddr_t pc) {
+    uint32_t h = hash_pc(pc);
+    size_t i;
+
+    for (i = 0; i < INSTSTAT_BLOCK_TABLE_SIZE; i++) {
+        BlockEntry *e = &block_table[(h + i) % INSTSTAT_BLOCK_TABLE_SIZE];
+        if (e->count == 0) {
+            e->pc = pc;
+            nr_blocks++;
+            return e;
+        }
+        if (e->pc == pc) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static EdgeEntry *find_edge(vaddr_t from, vaddr_t to) {
+    uint32_t h = hash_pc(from) ^ hash_pc(to * 31 + 7);
+    size_t i;
+
+    for (i = 0; i < INSTSTAT_EDGE_TABLE_SIZE; i++) {
+        EdgeEntry *e = &edge_table[(h + i) % INSTSTAT_EDGE_TABLE_SIZE];
+        if (e->count == 0) {
+            e->from = from;
+            e->to = to;
+            nr_edges++;
+            return e;
+        }
+        if (e->from == from && e->to == to) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void enter_block(vaddr_t pc) {
+    BlockEntry *e = find_block(pc);
+    if (e) {
+        e->count++;
+    } else {
+        nr_dropped++;
+    }
+}
+
+/* 程序结束时仍未结束的基本块以下一条指令的 PC 作为终点，仅在其从未结束过时记录长度 */
+static void close_cur_block(vaddr_t pc) {
+    BlockEntry *b;
+
+    if (!started) {
+        return;
+    }
+    b = find_block(cur_block);
+    if (b && b->bytes == 0) {
+        b->bytes = pc - cur_block;
+    }
+}
+
+/* 首次执行前调用，记录复位后进入的第一个基本块 */
+void inststat_start(vaddr_t pc) {
+    if (started) {
+        return;
+    }
+    started = true;
+    cur_block = pc;
+    cur_block_start = g_nr_guest_inst;
+    enter_block(pc);
+}
+
+void inststat_new_block(Decode *s) {
+    BlockEntry *b;
+    EdgeEntry *e;
+
+    inststat_block_end = false;
+    // 当前基本块到此结束，记录其长度
+    b = find_block(cur_block);
+    if (b) {
+        b->bytes = s->snpc - cur_block;
+        // 基本块在表中的位置固定不变，可直接用作 BBV 中的基本块编号
+        IFDEF(CONFIG_SIMPOINT, simpoint_block(b - block_table + 1, g_nr_guest_inst - cur_block_start));
+    }
+    e = find_edge(cur_block, s->dnpc);
+    if (e) {
+        e->count++;
+    } else {
+        nr_dropped++;
+    }
+    cur_block = s->dnpc;
+    cur_block_start = g_nr_guest_inst;
+    enter_block(cur_block);
+}
+
+static int cmp_inst(const void *a, const void *b) {
+    const InstStat *x = a, *y = b;
+    return x->count < y->count ? 1 : x->count > y->count ? -1 : strcmp(x->name, y->name);
+}
+
+/* 按执行的总字节数（近似于指令数）降序 */
+static int cmp_block(const void *a, const void *b) {
+    const BlockEntry *x = a, *y = b;
+    uint64_t wx = x->count * x->bytes, wy = y->count * y->bytes;
+    return wx < wy ? 1 : wx > wy ? -1 : (x->pc > y->pc) - (x->pc < y->pc);
+}
+
+static int cmp_edge(const void *a, const void *b) {
+    const EdgeEntry *x = a, *y = b;
+    return x->count < y->count ? 1 : x->count > y->count ? -1 : (x->from > y->from) - (x->from < y->from);
+}
+
+static void dump_size_json(FILE *fp, const char *key, uint64_t *sizes) {
+    int i;
+    bool first = true;
+
+    fprintf(fp, "  \"%s\": {", key);
+    for (i = 1; i < 9; i++) {
+        if (sizes[i] == 0) {
+            continue;
+        }
+        fprintf(fp, "%s\"%d\": %" PRIu64, first ? "" : ", ", i, sizes[i]);
+        first = false;
+    }
+    fprintf(fp, "}");
+}
+
+static void dump_json(InstStat *insts, size_t nr_insts, BlockEntry *blocks, EdgeEntry *edges) {
+    FILE *fp;
+    size_t i;
+
+    fp = fopen(CONFIG_INSTSTAT_OUT, "w");
+    if (fp == NULL) {
+        Log_info("Failed to open '%s' for instruction statistics!", CONFIG_INSTSTAT_OUT);
+        return;
+    }
+
+    fprintf(fp, "{\n  \"insts\": %" PRIu64 ",\n  \"opcodes\": {", g_nr_guest_inst);
+    for (i = 0; i < nr_insts; i++) {
+        fprintf(fp, "%s\"%s\": %" PRIu64, i == 0 ? "" : ", ", insts[i].name, insts[i].count);
+    }
+    fprintf(fp, "},\n");
+    dump_size_json(fp, "load_size", inststat_load_size);
+    fprintf(fp, ",\n");
+    dump_size_json(fp, "store_size", inststat_store_size);
+    fprintf(fp, ",\n  \"blocks\": [");
+    for (i = 0; i < nr_blocks; i++) {
+        fprintf(fp, "%s\n    {\"pc\": \"" FMT_WORD "\", \"bytes\": %" PRIu32 ", \"count\": %" PRIu64 "}",
+            i == 0 ? "" : ",", blocks[i].pc, blocks[i].bytes, blocks[i].count);
+    }
+    fprintf(fp, "\n  ],\n  \"edges\": [");
+    for (i = 0; i < nr_edges; i++) {
+        fprintf(fp, "%s\n    {\"from\": \"" FMT_WORD "\", \"to\": \"" FMT_WORD "\", \"count\": %" PRIu64 "}",
+            i == 0 ? "" : ",", edges[i].from, edges[i].to, edges[i].count);
+    }
+    fprintf(fp, "\n  ],\n  \"dropped\": %" PRIu64 "\n}\n", nr_dropped);
+    fclose(fp);
+    Log("instruction statistics written to %s", CONFIG_INSTSTAT_OUT);
+}
+
+void inststat_dump(void) {
+    static BlockEntry blocks[INSTSTAT_BLOCK_TABLE_SIZE];
+    static EdgeEntry edges[INSTSTAT_EDGE_TABLE_SIZE];
+    InstStat *insts;
+    size_t nr_insts, nr, i;
+    uint64_t total_loads = 0, total_stores = 0;
+
+    if (g_nr_guest_inst == 0) {
+        return;
+    }
+
+    close_cur_block(cpu.pc);
+
+    // 复制一份再排序，以免打乱计数器本身
+    nr_insts = __stop_nemu_inststat - __start_nemu_inststat;
+    insts = malloc(nr_insts * sizeof(InstStat));
+    Assert(insts, "Failed to allocate memory for instruction statistics");
+    memcpy(insts, __start_nemu_inststat, nr_insts * sizeof(InstStat));
+    qsort(insts, nr_insts, sizeof(InstStat), cmp_inst);
+
+    for (i = 0, nr = 0; i < INSTSTAT_BLOCK_TABLE_SIZE; i++) {
+        if (block_table[i].count != 0) {
+            blocks[nr++] = block_table[i];
+        }
+    }
+    qsort(blocks, nr_blocks, sizeof(BlockEntry), cmp_block);
+    for (i = 0, nr = 0; i < INSTSTAT_EDGE_TABLE_SIZE; i++) {
+        if (edge_table[i].count != 0) {
+            edges[nr++] = edge_table[i];
+        }
+    }
+    qsort(edges, nr_edges, sizeof(EdgeEntry), cmp_edge);
+
+    Log("instruction mix:");
+    Log("%-16s %14s %7s", "opcode", "count", "%");
+    for (i = 0; i < nr_insts && insts[i].count != 0; i++) {
+        Log("%-16s %14" PRIu64 " %6.2f%%", insts[i].name, insts[i].count,
+            insts[i].count * 100.0 / g_nr_guest_inst);
+    }
+
+    for (i = 1; i < 9; i++) {
+        total_loads += inststat_load_size[i];
+        total_stores += inststat_store_size[i];
+    }
+    Log("memory access size:");
+    Log("%-16s %14s %7s %14s %7s", "size", "loads", "%", "stores", "%");
+    for (i = 1; i < 9; i++) {
+        if (inststat_load_size[i] == 0 && inststat_store_size[i] == 0) {
+            continue;
+        }
+        Log("%-16zu %14" PRIu64 " %6.2f%% %14" PRIu64 " %6.2f%%", i,
+            inststat_load_size[i], total_loads ? inststat_load_size[i] * 100.0 / total_loads : 0,
+            inststat_store_size[i], total_stores ? inststat_store_size[i] * 100.0 / total_stores : 0);
+    }
+
+    Log("basic blocks: %zu blocks, %zu edges, %" PRIu64 " dropped", nr_blocks, nr_edges, nr_dropped);
+    Log("%-18s %8s %14s", "block", "bytes", "count");
+    for (i = 0; i < nr_blocks && i < INSTSTAT_TABLE_ROWS; i++) {
+        Log(FMT_WORD "         %8" PRIu32 " %14" PRIu64, blocks[i].pc, blocks[i].bytes, blocks[i].count);
+    }
+    Log("%-18s %-18s %14s", "from", "to", "count");
+    for (i = 0; i < nr_edges && i < INSTSTAT_TABLE_ROWS; i++) {
+        Log(FMT_WORD "         " FMT_WORD "         %14" PRIu64, edges[i].from, edges[i].to, edges[i].count);
+    }
+
+    dump_json(insts, nr_insts, blocks, edges);
+    free(insts);
+}
+
+#endif
@@ -0,0 +1,171 @@
+#include <common.h>
+#include <isa.h>
+#include <memory/paddr.h>
+#include <cpu/inststat.h>
+#include <cpu/simpoint.h>
+#include <sys/stat.h>
+
+#ifdef CONFIG_SIMPOINT
+
+extern uint64_t g_nr_guest_inst;
+
+/* 当前区间内各基本块执行的指令数，以基本块编号为索引 */
+static uint64_t interval_count[INSTSTAT_BLOCK_TABLE_SIZE + 1] = {};
+/* 当前区间内执行过的基本块编号，用于输出及清零 */
+static uint32_t touched[INSTSTAT_BLOCK_TABLE_SIZE + 1] = {};
+static size_t nr_touched = 0;
+static uint64_t cur_interval = 0;
+
+static FILE *bbv_fp = NULL;
+
+/* 需要保存检查点的区间编号（升序），由 SimPoint 选出 */
+static uint64_t *ckpt_intervals = NULL;
+static size_t nr_ckpt_intervals = 0;
+static size_t next_ckpt = 0;
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+/* 读取 SimPoint 输出的 simpoints 文件，每行形如 "<区间编号> <簇编号>" */
+static void load_simpoints(const char *simpoints_file) {
+    FILE *fp;
+    uint64_t interval;
+    int cluster;
+    size_t cap = 16;
+
+    fp = fopen(simpoints_file, "r");
+    Assert(fp, "Can not open simpoints file '%s'", simpoints_file);
+
+    ckpt_intervals = malloc(cap * sizeof(uint64_t));
+    Assert(ckpt_intervals, "Failed to allocate memory for simpoints");
+    while (fscanf(fp, "%" SCNu64 " %d", &interval, &cluster) == 2) {
+        if (nr_ckpt_intervals == cap) {
+            cap *= 2;
+            ckpt_intervals = realloc(ckpt_intervals, cap * sizeof(uint64_t));
+            Assert(ckpt_intervals, "Failed to allocate memory for simpoints");
+        }
+        ckpt_intervals[nr_ckpt_intervals++] = interval;
+    }
+    fclose(fp);
+
+    qsort(ckpt_intervals, nr_ckpt_intervals, sizeof(uint64_t), cmp_u64);
+    Log("%zu simpoints loaded from %s", nr_ckpt_intervals, simpoints_file);
+}
+
+static bool page_is_zero(const uint8_t *page) {
+    size_t i;
+
+    for (i = 0; i < SIMPOINT_CKPT_PAGE_SIZE; i++) {
+        if (page[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* 将当前的处理器状态与物理内存保存为检查点 */
+static void write_checkpoint(uint64_t interval) {
+    char path[256];
+    FILE *fp;
+    SimpointCkptHeader header = {};
+    uint64_t paddr;
+
+    snprintf(path, sizeof(path), CONFIG_SIMPOINT_CKPT_DIR "/ckpt_%" PRIu64 ".bin", interval);
+    fp = fopen(path, "wb");
+    if (fp == NULL) {
+        Log_info("Failed to open '%s' for checkpoint!", path);
+        return;
+    }
+
+    memcpy(header.magic, SIMPOINT_CKPT_MAGIC, sizeof(header.magic));
+    header.interval = interval;
+    header.inst_count = g_nr_guest_inst;
+    header.state_size = sizeof(CPU_state);
+    for (paddr = PMEM_LEFT; paddr - PMEM_LEFT < CONFIG_MSIZE; paddr += SIMPOINT_CKPT_PAGE_SIZE) {
+        if (!page_is_zero(guest_to_host(paddr))) {
+            header.nr_pages++;
+        }
+    }
+
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(&cpu, sizeof(CPU_state), 1, fp);
+    for (paddr = PMEM_LEFT; paddr - PMEM_LEFT < CONFIG_MSIZE; paddr += SIMPOINT_CKPT_PAGE_SIZE) {
+        uint8_t *page = guest_to_host(paddr);
+        uint64_t addr = paddr;
+        if (!page_is_zero(page)) {
+            fwrite(&addr, sizeof(addr), 1, fp);
+            fwrite(page, SIMPOINT_CKPT_PAGE_SIZE, 1, fp);
+        }
+    }
+    fclose(fp);
+    Log("checkpoint of interval %" PRIu64 " (pc = " FMT_WORD ", %" PRIu64 " pages) written to %s",
+        interval, cpu.pc, header.nr_pages, path);
+}
+
+/* 若当前区间被选中，则在其开始处保存检查点 */
+static void try_checkpoint(void) {
+    while (next_ckpt < nr_ckpt_intervals && ckpt_intervals[next_ckpt] < cur_interval) {
+        next_ckpt++;
+    }
+    if (next_ckpt < nr_ckpt_intervals && ckpt_intervals[next_ckpt] == cur_interval) {
+        write_checkpoint(cur_interval);
+        next_ckpt++;
+    }
+}
+
+void init_simpoint(const char *simpoints_file) {
+    bbv_fp = fopen(CONFIG_SIMPOINT_BBV_OUT, "w");
+    if (bbv_fp == NULL) {
+        Log_info("Failed to open '%s' for basic block vectors!", CONFIG_SIMPOINT_BBV_OUT);
+    }
+
+    if (simpoints_file) {
+        load_simpoints(simpoints_file);
+        if (mkdir(CONFIG_SIMPOINT_CKPT_DIR, 0755) != 0 && errno != EEXIST) {
+            Log_info("Failed to create checkpoint directory '%s'!", CONFIG_SIMPOINT_CKPT_DIR);
+        }
+        try_checkpoint();
+    }
+}
+
+void simpoint_block(uint32_t id, uint64_t insts) {
+    if (interval_count[id] == 0) {
+        touched[nr_touched++] = id;
+    }
+    interval_count[id] += insts;
+}
+
+/* 每执行完 SIMPOINT_INTERVAL 条指令调用一次，以 SimPoint 的 .bb 格式输出本区间的 BBV */
+void simpoint_interval_end(void) {
+    size_t i;
+
+    if (bbv_fp && nr_touched > 0) {
+        fputc('T', bbv_fp);
+        for (i = 0; i < nr_touched; i++) {
+            fprintf(bbv_fp, ":%" PRIu32 ":%" PRIu64 " ", touched[i], interval_count[touched[i]]);
+        }
+        fputc('\n', bbv_fp);
+    }
+    for (i = 0; i < nr_touched; i++) {
+        interval_count[touched[i]] = 0;
+    }
+    nr_touched = 0;
+
+    cur_interval++;
+    try_checkpoint();
+}
+
+void simpoint_finish(void) {
+    if (bbv_fp == NULL) {
+        return;
+    }
+    // 最后一个不完整的区间同样输出，SimPoint 会按其指令数加权
+    simpoint_interval_end();
+    fclose(bbv_fp);
+    bbv_fp = NULL;
+    Log("basic block vectors of %" PRIu64 " intervals written to %s", cur_interval, CONFIG_SIMPOINT_BBV_OUT);
+}
+
+#endif
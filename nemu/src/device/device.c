@@ -22,6 +22,7 @@
 
 void init_map();
 void init_serial();
+void serial_flush();
 void init_timer();
 void init_vga();
 void init_i8042();
@@ -42,6 +43,9 @@ void device_update() {
   last = now;
 
   IFDEF(CONFIG_HAS_VGA, vga_update_screen());
+#if defined(CONFIG_HAS_SERIAL) && !defined(CONFIG_TARGET_AM)
+  serial_flush();
+#endif
 
 #ifndef CONFIG_TARGET_AM
   SDL_Event event;
@@ -21,11 +21,50 @@
 
 #define CH_OFFSET 0
 
+/*
+ * TX FIFO: the guest fills the burst buffer with word stores, then writes the
+ * number of valid bytes to the doorbell register to send them all at once.
+ */
+#define TX_SIZE_OFFSET  0x000
+#define TX_COUNT_OFFSET 0x004
+#define TX_BUF_OFFSET   0x400
+#define TX_BUF_SIZE     0x400
+#define TX_SPACE_SIZE   (TX_BUF_OFFSET + TX_BUF_SIZE)
+
 static uint8_t *serial_base = NULL;
+static uint8_t *serial_tx_base = NULL;
 
+#ifndef CONFIG_TARGET_AM
+/* Host output is batched, and flushed on newline, when full, or by the timer. */
+#define HOST_BUF_SIZE 4096
+static char host_buf[HOST_BUF_SIZE];
+static size_t host_len = 0;
+
+void serial_flush() {
+  if (host_len > 0) {
+    fwrite(host_buf, 1, host_len, stderr);
+    fflush(stderr);
+    host_len = 0;
+  }
+}
+#endif
+
+static void serial_write(const char *buf, size_t len) {
+#ifdef CONFIG_TARGET_AM
+  for (size_t i = 0; i < len; i++) putch(buf[i]);
+#else
+  bool newline = false;
+  for (size_t i = 0; i < len; i++) {
+    if (host_len == HOST_BUF_SIZE) serial_flush();
+    host_buf[host_len++] = buf[i];
+    newline |= buf[i] == '\n';
+  }
+  if (newline) serial_flush();
+#endif
+}
 
 static void serial_putc(char ch) {
-  MUXDEF(CONFIG_TARGET_AM, putch(ch), putc(ch, stderr));
+  serial_write(&ch, 1);
 }
 
 static void serial_io_handler(uint32_t offset, int len, bool is_write) {
@@ -40,6 +79,12 @@ static void serial_io_handler(uint32_t offset, int len, bool is_write) {
   }
 }
 
+static void serial_tx_io_handler(uint32_t offset, int len, bool is_write) {
+  if (!is_write || offset != TX_COUNT_OFFSET) return;
+  uint32_t count = *(uint32_t *)(serial_tx_base + TX_COUNT_OFFSET);
+  serial_write((const char *)(serial_tx_base + TX_BUF_OFFSET), count < TX_BUF_SIZE ? count : TX_BUF_SIZE);
+}
+
 void init_serial() {
   serial_base = new_space(8);
 #ifdef CONFIG_HAS_PORT_IO
@@ -48,4 +93,9 @@ void init_serial() {
   add_mmio_map("serial", CONFIG_SERIAL_MMIO, serial_base, 8, serial_io_handler);
 #endif
 
+  serial_tx_base = new_space(TX_SPACE_SIZE);
+  *(uint32_t *)(serial_tx_base + TX_SIZE_OFFSET) = TX_BUF_SIZE;
+  add_mmio_map("serial-tx", CONFIG_SERIAL_TX_MMIO, serial_tx_base, TX_SPACE_SIZE, serial_tx_io_handler);
+  IFNDEF(CONFIG_TARGET_AM, atexit(serial_flush));
+
 }
@@ -18,6 +18,8 @@
 #include <cpu/cpu.h>
 #include <cpu/ifetch.h>
 #include <cpu/decode.h>
+#include <cpu/inststat.h>
+#include <cpu/bpred.h>
 
 #include <utils.h>
 
@@ -288,6 +290,46 @@ static void handle_ftrace_inst_jal(Decode *s, int rd, int imm) {
 static void handle_ftrace(Decode *s);
 #endif
 
+#ifdef CONFIG_BPRED
+/* x1 与 x5 是 RISC-V 约定的链接寄存器，据此区分函数调用、返回与其他跳转 */
+#define IS_LINK_REG(r) ((r) == 1 || (r) == 5)
+
+static void handle_bpred(Decode *s) {
+  uint32_t i = s->isa.inst;
+  int rd = BITS(i, 11, 7);
+  int rs1 = BITS(i, 19, 15);
+  BranchInfo b = { .pc = s->pc, .taken = true, .target = s->dnpc, .fallthrough = s->snpc };
+
+  switch (BITS(i, 6, 0)) {
+    case 0b1100011: // 条件分支
+      b.kind = BRANCH_COND;
+      b.taken = s->dnpc != s->snpc;
+      b.target = s->pc + ((SEXT(BITS(i, 31, 31), 1) << 12) | (BITS(i, 7, 7) << 11) |
+        (BITS(i, 30, 25) << 5) | (BITS(i, 11, 8) << 1));
+      break;
+    case 0b1101111: // jal
+      b.kind = IS_LINK_REG(rd) ? BRANCH_CALL : BRANCH_JUMP;
+      break;
+    case 0b1100111: // jalr
+      if (IS_LINK_REG(rd)) b.kind = BRANCH_CALL;
+      else if (IS_LINK_REG(rs1)) b.kind = BRANCH_RET;
+      else b.kind = BRANCH_INDIRECT;
+      break;
+    default: return;
+  }
+  bpred_branch(&b);
+}
+#endif
+
+#ifdef CONFIG_INSTSTAT
+#define INSTSTAT_HIT(name, type) do { \
+  INSTSTAT_INC(name); \
+  if (concat(TYPE_, type) == TYPE_B) inststat_block_end = true; \
+} while (0)
+#else
+#define INSTSTAT_HIT(name, type)
+#endif
+
 static int decode_exec(Decode *s) {
   s->dnpc = s->snpc;
 
@@ -304,6 +346,7 @@ static int decode_exec(Decode *s) {
     &imm, &simm, &immm, \
     concat(TYPE_, type) \
   ); \
+  INSTSTAT_HIT(name, type); \
   __VA_ARGS__ ; \
 }
 
@@ -335,7 +378,7 @@ static int decode_exec(Decode *s) {
   INSTPAT("??????? ????? ????? 011 ????? 00100 11", sltiu   , I, R(rd) = src1 < imm ? 1 : 0);
   INSTPAT("??????? ????? ????? 100 ????? 00100 11", xori    , I, R(rd) = src1 ^ imm);
   INSTPAT("??????? ????? ????? 110 ????? 00100 11", ori     , I, R(rd) = src1 | imm);
-  INSTPAT("??????? ????? ????? 111 ????? 00100 11", ori     , I, R(rd) = src1 & imm);
+  INSTPAT("??????? ????? ????? 111 ????? 00100 11", andi    , I, R(rd) = src1 & imm);
   INSTPAT("0000000 ????? ????? 001 ????? 00100 11", slli    , I, R(rd) = src1 << immm);
   INSTPAT("0000000 ????? ????? 101 ????? 00100 11", srli    , I, R(rd) = src1 >> immm);
   INSTPAT("0100000 ????? ????? 101 ????? 00100 11", srai    , I, R(rd) = (word_t) (ssrc1 >> immm));
@@ -398,6 +441,8 @@ static int decode_exec(Decode *s) {
 
 #endif
 
+  IFDEF(CONFIG_BPRED, handle_bpred(s));
+
   R(0) = 0; // reset $zero to 0
 
   return 0;
@@ -28,6 +28,10 @@ static uint8_t pmem[CONFIG_MSIZE] PG_ALIGN = {};
 uint8_t* guest_to_host(paddr_t paddr) { return pmem + paddr - CONFIG_MBASE; }
 paddr_t host_to_guest(uint8_t *haddr) { return haddr - pmem + CONFIG_MBASE; }
 
+#ifdef CONFIG_CACHESIM
+static CacheSweep *cachesim = NULL;
+#endif
+
 static word_t pmem_read(paddr_t addr, int len) {
   word_t ret = host_read(guest_to_host(addr), len);
   return ret;
@@ -52,8 +56,26 @@ void init_mem() {
 #endif
   IFDEF(CONFIG_MEM_RANDOM, memset(pmem, rand(), CONFIG_MSIZE));
   Log("physical memory area [" FMT_PADDR ", " FMT_PADDR "]", PMEM_LEFT, PMEM_RIGHT);
+#ifdef CONFIG_CACHESIM
+  cachesim = cachesim_create(CONFIG_CACHESIM_CONFIGS, CONFIG_CACHESIM_THREADS);
+  Assert(cachesim, "invalid cache configurations: %s", CONFIG_CACHESIM_CONFIGS);
+#endif
+}
+
+#ifdef CONFIG_CACHESIM
+void paddr_cachesim_access(paddr_t addr, int len, CacheAccessType type) {
+  cachesim_access(cachesim, addr, len, type);
+}
+
+static void cachesim_log(const char *line) {
+  Log("%s", line);
 }
 
+void paddr_cachesim_report(uint64_t insts) {
+  cachesim_report(cachesim, insts, cachesim_log);
+}
+#endif
+
 #ifdef CONFIG_MTRACE
 static void mtrace_record(
   paddr_t addr, int len,
@@ -81,6 +103,11 @@ word_t paddr_read_mtrace(paddr_t addr, int len, bool mtrace_on) {
 
   if (likely(in_pmem(addr))) {
     res = pmem_read(addr, len);
+#ifdef CONFIG_CACHESIM
+    if (mtrace_on) {
+      paddr_cachesim_access(addr, len, CACHE_ACCESS_READ);
+    }
+#endif
 #ifdef CONFIG_MTRACE
     if (mtrace_on) {
       mtrace_record(addr, len, res, "read");
@@ -110,6 +137,11 @@ void paddr_write_mtrace(paddr_t addr, int len, word_t data, bool mtrace_on) {
   if (mtrace_on) {
     mtrace_record(addr, len, data, "write");
   }
+#endif
+#ifdef CONFIG_CACHESIM
+  if (mtrace_on && likely(in_pmem(addr))) {
+    paddr_cachesim_access(addr, len, CACHE_ACCESS_WRITE);
+  }
 #endif
   if (likely(in_pmem(addr))) { pmem_write(addr, len, data); return; }
   IFDEF(CONFIG_DEVICE, mmio_write(addr, len, data); return);
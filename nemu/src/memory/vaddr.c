@@ -16,12 +16,15 @@
 #include <isa.h>
 #include <memory/paddr.h>
 #include <memory/vaddr.h>
+#include <cpu/inststat.h>
 
 word_t vaddr_ifetch(vaddr_t addr, int len) {
+  IFDEF(CONFIG_CACHESIM, paddr_cachesim_access(addr, len, CACHE_ACCESS_IFETCH));
   return paddr_read_mtrace(addr, len, false);
 }
 
 word_t vaddr_read(vaddr_t addr, int len) {
+  IFDEF(CONFIG_INSTSTAT, inststat_load_size[len] ++);
   return vaddr_read_mtrace(addr, len, true);
 }
 
@@ -30,6 +33,7 @@ word_t vaddr_read_mtrace(vaddr_t addr, int len, bool mtrace_on) {
 }
 
 void vaddr_write(vaddr_t addr, int len, word_t data) {
+  IFDEF(CONFIG_INSTSTAT, inststat_store_size[len] ++);
   return vaddr_write_mtrace(addr, len, data, true);
 }
 
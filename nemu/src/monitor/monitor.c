@@ -23,6 +23,7 @@ void init_difftest(char *ref_so_file, long img_size, int port);
 void init_device();
 void init_sdb();
 void init_disasm();
+void init_simpoint(const char *simpoints_file);
 
 static void welcome() {
   Log("Trace: %s", MUXDEF(CONFIG_TRACE, ANSI_FMT("ON", ANSI_FG_GREEN), ANSI_FMT("OFF", ANSI_FG_RED)));
@@ -46,6 +47,7 @@ static char *log_file = NULL;
 static char *diff_so_file = NULL;
 static char *img_file = NULL;
 static char *elf_file = NULL;
+static char *simpoints_file = NULL;
 static int difftest_port = 1234;
 
 static long load_img() {
@@ -120,17 +122,19 @@ static int parse_args(int argc, char *argv[]) {
     {"diff"     , required_argument, NULL, 'd'},
     {"port"     , required_argument, NULL, 'p'},
     {"elf"      , required_argument, NULL, 'e'},
+    {"simpoints", required_argument, NULL, 's'},
     {"help"     , no_argument      , NULL, 'h'},
     {0          , 0                , NULL,  0 },
   };
   int o;
-  while ( (o = getopt_long(argc, argv, "-bhl:d:p:e:", table, NULL)) != -1) {
+  while ( (o = getopt_long(argc, argv, "-bhl:d:p:e:s:", table, NULL)) != -1) {
     switch (o) {
       case 'b': sdb_set_batch_mode(); break;
       case 'p': sscanf(optarg, "%d", &difftest_port); break;
       case 'l': log_file = optarg; break;
       case 'd': diff_so_file = optarg; break;
       case 'e': elf_file = optarg; break;
+      case 's': simpoints_file = optarg; break;
       case 1: img_file = optarg; return 0;
       default:
         printf("Usage: %s [OPTION...] IMAGE [args]\n\n", argv[0]);
@@ -139,6 +143,7 @@ static int parse_args(int argc, char *argv[]) {
         printf("\t-d,--diff=REF_SO        run DiffTest with reference REF_SO\n");
         printf("\t-p,--port=PORT          run DiffTest with port PORT\n");
         printf("\t-e,--elf=FILE           specify the ELF file to load\n");
+        printf("\t-s,--simpoints=FILE     write checkpoints at the SimPoint intervals in FILE\n");
         printf("\n");
         exit(0);
     }
@@ -176,6 +181,9 @@ void init_monitor(int argc, char *argv[]) {
   Log_info("Loaded %lu function symbols from ELF file.", nemu_state.ftrace_func_syms_size);
 #endif
 
+  /* Initialize SimPoint profiling, which may checkpoint the initial state. */
+  IFDEF(CONFIG_SIMPOINT, init_simpoint(simpoints_file));
+
   /* Initialize differential testing. */
   init_difftest(diff_so_file, img_size, difftest_port);
 
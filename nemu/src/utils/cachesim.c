@@ -0,0 +1,532 @@
+#include <ctype.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utils/cachesim.h>
+
+#define CACHESIM_BATCH_SIZE 65536
+#define CACHESIM_MAX_CONFIGS 256
+
+typedef enum { CACHE_REPL_LRU, CACHE_REPL_PLRU, CACHE_REPL_RANDOM } CacheReplPolicy;
+typedef enum { CACHE_WRITE_BACK, CACHE_WRITE_THROUGH } CacheWritePolicy;
+
+/* 一级缓存 */
+typedef struct Cache {
+    bool present;
+    uint32_t size;
+    uint32_t ways;
+    uint32_t line_shift;
+    uint32_t nr_sets;
+    uint32_t latency;
+    CacheReplPolicy repl;
+    CacheWritePolicy write;
+
+    /* 以 set * ways + way 为索引 */
+    uint64_t *tags;
+    uint64_t *stamps;
+    uint8_t *valid;
+    uint8_t *dirty;
+    /* 每组一棵 PLRU 树，结点按堆的方式从 1 开始编号 */
+    uint64_t *plru;
+    uint64_t clock;
+    uint64_t rand_state;
+
+    uint64_t accesses[NR_CACHE_ACCESS_TYPE];
+    uint64_t misses[NR_CACHE_ACCESS_TYPE];
+    uint64_t writebacks;
+} Cache;
+
+/* 一个完整的缓存层次配置 */
+typedef struct {
+    char name[256];
+    Cache l1i;
+    Cache l1d;
+    Cache l2;
+    uint32_t mem_latency;
+    uint64_t mem_reads;
+    uint64_t mem_writes;
+    /* 所有 L1 访问的总延迟，用于计算 AMAT */
+    uint64_t total_latency;
+    uint64_t total_accesses;
+} CacheHierarchy;
+
+typedef struct {
+    uint64_t addr;
+    int len;
+    CacheAccessType type;
+} CacheAccess;
+
+struct CacheSweep {
+    CacheHierarchy *configs;
+    int nr_configs;
+    int nr_threads;
+    CacheAccess *batch;
+    size_t batch_size;
+};
+
+typedef struct {
+    CacheSweep *sweep;
+    int first;
+    int last;
+} CacheWorker;
+
+static const char *access_names[NR_CACHE_ACCESS_TYPE] = { "ifetch", "read", "write" };
+
+static uint32_t log2_u32(uint32_t x) {
+    uint32_t r = 0;
+    while ((1u << r) < x) {
+        r++;
+    }
+    return r;
+}
+
+static bool is_pow2(uint32_t x) {
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+/* 解析带 K/M 后缀的容量 */
+static bool parse_size(const char *s, uint32_t *out) {
+    char *end;
+    unsigned long v = strtoul(s, &end, 10);
+
+    if (end == s) {
+        return false;
+    }
+    if (*end == 'K' || *end == 'k') {
+        v <<= 10;
+        end++;
+    } else if (*end == 'M' || *end == 'm') {
+        v <<= 20;
+        end++;
+    }
+    *out = (uint32_t) v;
+    return *end == '\0';
+}
+
+static bool cache_init(Cache *c, char *spec) {
+    char *fields[8];
+    int nr_fields = 0, i;
+    uint32_t line_size;
+    char *p;
+
+    for (p = strtok(spec, ":"); p && nr_fields < 8; p = strtok(NULL, ":")) {
+        fields[nr_fields++] = p;
+    }
+    if (nr_fields < 3 || !parse_size(fields[0], &c->size) ||
+        !parse_size(fields[1], &c->ways) || !parse_size(fields[2], &line_size)) {
+        return false;
+    }
+    c->repl = CACHE_REPL_LRU;
+    c->write = CACHE_WRITE_BACK;
+    c->latency = 1;
+    for (i = 3; i < nr_fields; i++) {
+        if (strcmp(fields[i], "lru") == 0) {
+            c->repl = CACHE_REPL_LRU;
+        } else if (strcmp(fields[i], "plru") == 0) {
+            c->repl = CACHE_REPL_PLRU;
+        } else if (strcmp(fields[i], "random") == 0) {
+            c->repl = CACHE_REPL_RANDOM;
+        } else if (strcmp(fields[i], "wb") == 0) {
+            c->write = CACHE_WRITE_BACK;
+        } else if (strcmp(fields[i], "wt") == 0) {
+            c->write = CACHE_WRITE_THROUGH;
+        } else if (isdigit((unsigned char) fields[i][0])) {
+            c->latency = (uint32_t) strtoul(fields[i], NULL, 10);
+        } else {
+            return false;
+        }
+    }
+    if (!is_pow2(line_size) || !is_pow2(c->ways) || c->ways > 64 ||
+        c->size % (line_size * c->ways) != 0 || !is_pow2(c->size / (line_size * c->ways))) {
+        return false;
+    }
+
+    c->present = true;
+    c->line_shift = log2_u32(line_size);
+    c->nr_sets = c->size / (line_size * c->ways);
+    c->tags = (uint64_t *) calloc((size_t) c->nr_sets * c->ways, sizeof(uint64_t));
+    c->stamps = (uint64_t *) calloc((size_t) c->nr_sets * c->ways, sizeof(uint64_t));
+    c->valid = (uint8_t *) calloc((size_t) c->nr_sets * c->ways, sizeof(uint8_t));
+    c->dirty = (uint8_t *) calloc((size_t) c->nr_sets * c->ways, sizeof(uint8_t));
+    c->plru = (uint64_t *) calloc(c->nr_sets, sizeof(uint64_t));
+    c->rand_state = 0x2545f4914f6cdd1dull;
+    return c->tags && c->stamps && c->valid && c->dirty && c->plru;
+}
+
+static void cache_free(Cache *c) {
+    free(c->tags);
+    free(c->stamps);
+    free(c->valid);
+    free(c->dirty);
+    free(c->plru);
+}
+
+static void plru_touch(Cache *c, uint32_t set, uint32_t way) {
+    uint32_t levels = log2_u32(c->ways), node = 1, l;
+    uint64_t bits = c->plru[set];
+
+    for (l = 0; l < levels; l++) {
+        uint32_t bit = (way >> (levels - 1 - l)) & 1;
+        // 结点指向刚访问过的另一侧
+        if (bit) {
+            bits &= ~(1ull << node);
+        } else {
+            bits |= 1ull << node;
+        }
+        node = node * 2 + bit;
+    }
+    c->plru[set] = bits;
+}
+
+static uint32_t plru_victim(Cache *c, uint32_t set) {
+    uint32_t levels = log2_u32(c->ways), node = 1, l;
+
+    for (l = 0; l < levels; l++) {
+        node = node * 2 + ((c->plru[set] >> node) & 1);
+    }
+    return node - c->ways;
+}
+
+static uint32_t choose_victim(Cache *c, uint32_t set) {
+    size_t base = (size_t) set * c->ways;
+    uint32_t way, victim = 0;
+
+    for (way = 0; way < c->ways; way++) {
+        if (!c->valid[base + way]) {
+            return way;
+        }
+    }
+    switch (c->repl) {
+        case CACHE_REPL_PLRU:
+            return plru_victim(c, set);
+        case CACHE_REPL_RANDOM:
+            c->rand_state ^= c->rand_state << 13;
+            c->rand_state ^= c->rand_state >> 7;
+            c->rand_state ^= c->rand_state << 17;
+            return (uint32_t) (c->rand_state % c->ways);
+        default:
+            for (way = 1; way < c->ways; way++) {
+                if (c->stamps[base + way] < c->stamps[base + victim]) {
+                    victim = way;
+                }
+            }
+            return victim;
+    }
+}
+
+static uint32_t level_access(CacheHierarchy *h, Cache *c, uint64_t line_addr, CacheAccessType type);
+
+/* 访问 c 的下一级（L2 或主存），返回延迟 */
+static uint32_t next_level_access(CacheHierarchy *h, Cache *c, uint64_t line_addr, CacheAccessType type) {
+    if (c != &h->l2 && h->l2.present) {
+        // L1 与 L2 的行大小可以不同，按字节地址换算
+        return level_access(h, &h->l2, (line_addr << c->line_shift) >> h->l2.line_shift, type);
+    }
+    if (type == CACHE_ACCESS_WRITE) {
+        h->mem_writes++;
+    } else {
+        h->mem_reads++;
+    }
+    return h->mem_latency;
+}
+
+/* 以行为单位访问一级缓存，返回该次访问的延迟 */
+static uint32_t level_access(CacheHierarchy *h, Cache *c, uint64_t line_addr, CacheAccessType type) {
+    uint32_t set = (uint32_t) (line_addr & (c->nr_sets - 1));
+    uint64_t tag = line_addr >> log2_u32(c->nr_sets);
+    size_t base = (size_t) set * c->ways;
+    uint32_t way, latency = c->latency;
+
+    c->accesses[type]++;
+    c->clock++;
+    for (way = 0; way < c->ways; way++) {
+        if (c->valid[base + way] && c->tags[base + way] == tag) {
+            break;
+        }
+    }
+
+    if (way == c->ways) {
+        c->misses[type]++;
+        if (type == CACHE_ACCESS_WRITE && c->write == CACHE_WRITE_THROUGH) {
+            // 写直达采用写不分配，写操作由写缓冲完成，不计入延迟
+            next_level_access(h, c, line_addr, CACHE_ACCESS_WRITE);
+            return latency;
+        }
+        way = choose_victim(c, set);
+        if (c->valid[base + way] && c->dirty[base + way]) {
+            uint64_t victim_line = (c->tags[base + way] << log2_u32(c->nr_sets)) | set;
+            c->writebacks++;
+            next_level_access(h, c, victim_line, CACHE_ACCESS_WRITE);
+        }
+        latency += next_level_access(h, c, line_addr,
+            type == CACHE_ACCESS_IFETCH ? CACHE_ACCESS_IFETCH : CACHE_ACCESS_READ);
+        c->valid[base + way] = 1;
+        c->dirty[base + way] = 0;
+        c->tags[base + way] = tag;
+    }
+
+    c->stamps[base + way] = c->clock;
+    if (c->repl == CACHE_REPL_PLRU) {
+        plru_touch(c, set, way);
+    }
+    if (type == CACHE_ACCESS_WRITE) {
+        if (c->write == CACHE_WRITE_BACK) {
+            c->dirty[base + way] = 1;
+        } else {
+            next_level_access(h, c, line_addr, CACHE_ACCESS_WRITE);
+        }
+    }
+    return latency;
+}
+
+static void hierarchy_access(CacheHierarchy *h, const CacheAccess *a) {
+    Cache *c = a->type == CACHE_ACCESS_IFETCH ? &h->l1i : &h->l1d;
+    uint64_t first, last, line;
+    uint32_t latency = 0;
+
+    if (!c->present) {
+        c = h->l2.present ? &h->l2 : NULL;
+    }
+    if (c == NULL) {
+        latency = h->mem_latency;
+        if (a->type == CACHE_ACCESS_WRITE) {
+            h->mem_writes++;
+        } else {
+            h->mem_reads++;
+        }
+    } else {
+        // 跨行的访问拆成多次，延迟取其中最长的一次
+        first = a->addr >> c->line_shift;
+        last = (a->addr + a->len - 1) >> c->line_shift;
+        for (line = first; line <= last; line++) {
+            uint32_t l = level_access(h, c, line, a->type);
+            latency = l > latency ? l : latency;
+        }
+    }
+    h->total_latency += latency;
+    h->total_accesses++;
+}
+
+static bool hierarchy_init(CacheHierarchy *h, const char *spec) {
+    char buf[256], *level, *save = NULL;
+
+    memset(h, 0, sizeof(*h));
+    snprintf(h->name, sizeof(h->name), "%s", spec);
+    snprintf(buf, sizeof(buf), "%s", spec);
+    h->mem_latency = 100;
+
+    for (level = strtok_r(buf, ",", &save); level; level = strtok_r(NULL, ",", &save)) {
+        char *eq = strchr(level, '=');
+        if (eq == NULL) {
+            return false;
+        }
+        *eq = '\0';
+        if (strcmp(level, "l1i") == 0) {
+            if (!cache_init(&h->l1i, eq + 1)) return false;
+        } else if (strcmp(level, "l1d") == 0) {
+            if (!cache_init(&h->l1d, eq + 1)) return false;
+        } else if (strcmp(level, "l2") == 0) {
+            if (!cache_init(&h->l2, eq + 1)) return false;
+        } else if (strcmp(level, "mem") == 0) {
+            h->mem_latency = (uint32_t) strtoul(eq + 1, NULL, 10);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void hierarchy_free(CacheHierarchy *h) {
+    cache_free(&h->l1i);
+    cache_free(&h->l1d);
+    cache_free(&h->l2);
+}
+
+CacheSweep *cachesim_create(const char *configs, int nr_threads) {
+    CacheSweep *sweep;
+    const char *p = configs, *end;
+    char spec[256];
+
+    sweep = (CacheSweep *) calloc(1, sizeof(CacheSweep));
+    if (sweep == NULL) {
+        return NULL;
+    }
+    sweep->configs = (CacheHierarchy *) calloc(CACHESIM_MAX_CONFIGS, sizeof(CacheHierarchy));
+    sweep->batch = (CacheAccess *) malloc(CACHESIM_BATCH_SIZE * sizeof(CacheAccess));
+    sweep->nr_threads = nr_threads > 0 ? nr_threads : 1;
+    if (sweep->configs == NULL || sweep->batch == NULL) {
+        cachesim_destroy(sweep);
+        return NULL;
+    }
+
+    while (*p) {
+        end = strchr(p, '|');
+        if (end == NULL) {
+            end = p + strlen(p);
+        }
+        if ((size_t) (end - p) >= sizeof(spec) || sweep->nr_configs == CACHESIM_MAX_CONFIGS) {
+            cachesim_destroy(sweep);
+            return NULL;
+        }
+        memcpy(spec, p, end - p);
+        spec[end - p] = '\0';
+        if (!hierarchy_init(&sweep->configs[sweep->nr_configs++], spec)) {
+            fprintf(stderr, "[cachesim] invalid cache configuration '%s'\n", spec);
+            cachesim_destroy(sweep);
+            return NULL;
+        }
+        p = *end ? end + 1 : end;
+    }
+    if (sweep->nr_configs == 0) {
+        cachesim_destroy(sweep);
+        return NULL;
+    }
+    return sweep;
+}
+
+static void *worker_main(void *arg) {
+    CacheWorker *w = (CacheWorker *) arg;
+    int i;
+    size_t j;
+
+    for (i = w->first; i < w->last; i++) {
+        for (j = 0; j < w->sweep->batch_size; j++) {
+            hierarchy_access(&w->sweep->configs[i], &w->sweep->batch[j]);
+        }
+    }
+    return NULL;
+}
+
+/* 各配置互不相关，按配置划分给多个线程处理同一批访存 */
+static void flush_batch(CacheSweep *sweep) {
+    pthread_t threads[CACHESIM_MAX_CONFIGS];
+    CacheWorker workers[CACHESIM_MAX_CONFIGS];
+    int nr = sweep->nr_threads < sweep->nr_configs ? sweep->nr_threads : sweep->nr_configs;
+    int i;
+
+    if (sweep->batch_size == 0) {
+        return;
+    }
+    for (i = 0; i < nr; i++) {
+        workers[i].sweep = sweep;
+        workers[i].first = sweep->nr_configs * i / nr;
+        workers[i].last = sweep->nr_configs * (i + 1) / nr;
+    }
+    if (nr == 1) {
+        worker_main(&workers[0]);
+    } else {
+        for (i = 0; i < nr; i++) {
+            pthread_create(&threads[i], NULL, worker_main, &workers[i]);
+        }
+        for (i = 0; i < nr; i++) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    sweep->batch_size = 0;
+}
+
+void cachesim_access(CacheSweep *sweep, uint64_t addr, int len, CacheAccessType type) {
+    CacheAccess *a = &sweep->batch[sweep->batch_size++];
+
+    a->addr = addr;
+    a->len = len;
+    a->type = type;
+    if (sweep->batch_size == CACHESIM_BATCH_SIZE) {
+        flush_batch(sweep);
+    }
+}
+
+static uint64_t sum_accesses(const Cache *c) {
+    return c->accesses[CACHE_ACCESS_IFETCH] + c->accesses[CACHE_ACCESS_READ] + c->accesses[CACHE_ACCESS_WRITE];
+}
+
+static uint64_t sum_misses(const Cache *c) {
+    return c->misses[CACHE_ACCESS_IFETCH] + c->misses[CACHE_ACCESS_READ] + c->misses[CACHE_ACCESS_WRITE];
+}
+
+static double hit_rate(const Cache *c) {
+    uint64_t n = sum_accesses(c);
+    return n ? 100.0 * (n - sum_misses(c)) / n : 0;
+}
+
+static double mpki(const Cache *c, uint64_t insts) {
+    return insts ? 1000.0 * sum_misses(c) / insts : 0;
+}
+
+static void report_line(CacheReportFn out, const char *fmt, ...) {
+    char line[512];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    out(line);
+}
+
+static void report_cache(CacheReportFn out, const char *name, const Cache *c, uint64_t insts) {
+    int t;
+
+    if (!c->present) {
+        return;
+    }
+    report_line(out, "  %-4s %" PRIu32 "B %" PRIu32 "-way %" PRIu32 "B lines, %s, %s: "
+        "%" PRIu64 " accesses, %" PRIu64 " misses, hit rate %.2f%%, MPKI %.3f, %" PRIu64 " writebacks",
+        name, c->size, c->ways, 1u << c->line_shift,
+        c->repl == CACHE_REPL_LRU ? "lru" : c->repl == CACHE_REPL_PLRU ? "plru" : "random",
+        c->write == CACHE_WRITE_BACK ? "wb" : "wt",
+        sum_accesses(c), sum_misses(c), hit_rate(c), mpki(c, insts), c->writebacks);
+    for (t = 0; t < NR_CACHE_ACCESS_TYPE; t++) {
+        if (c->accesses[t] == 0) {
+            continue;
+        }
+        report_line(out, "       %-6s %14" PRIu64 " accesses %14" PRIu64 " misses",
+            access_names[t], c->accesses[t], c->misses[t]);
+    }
+}
+
+void cachesim_report(CacheSweep *sweep, uint64_t insts, CacheReportFn out) {
+    int i;
+
+    flush_batch(sweep);
+    for (i = 0; i < sweep->nr_configs; i++) {
+        CacheHierarchy *h = &sweep->configs[i];
+        report_line(out, "[cachesim] %s", h->name);
+        report_cache(out, "L1I", &h->l1i, insts);
+        report_cache(out, "L1D", &h->l1d, insts);
+        report_cache(out, "L2", &h->l2, insts);
+        report_line(out, "  mem  %" PRIu64 " reads, %" PRIu64 " writes", h->mem_reads, h->mem_writes);
+        report_line(out, "  AMAT %.3f cycles", h->total_accesses ? (double) h->total_latency / h->total_accesses : 0);
+    }
+
+    // 扫描多个配置时额外给出一张便于比较的汇总表
+    if (sweep->nr_configs > 1) {
+        report_line(out, "[cachesim] %-8s %-8s %-8s %-9s %-9s %-9s %-8s config",
+            "L1I hit%", "L1D hit%", "L2 hit%", "L1I MPKI", "L1D MPKI", "L2 MPKI", "AMAT");
+        for (i = 0; i < sweep->nr_configs; i++) {
+            CacheHierarchy *h = &sweep->configs[i];
+            report_line(out, "[cachesim] %8.2f %8.2f %8.2f %9.3f %9.3f %9.3f %8.3f %s",
+                hit_rate(&h->l1i), hit_rate(&h->l1d), hit_rate(&h->l2),
+                mpki(&h->l1i, insts), mpki(&h->l1d, insts), mpki(&h->l2, insts),
+                h->total_accesses ? (double) h->total_latency / h->total_accesses : 0, h->name);
+        }
+    }
+}
+
+void cachesim_destroy(CacheSweep *sweep) {
+    int i;
+
+    if (sweep == NULL) {
+        return;
+    }
+    if (sweep->configs) {
+        for (i = 0; i < sweep->nr_configs; i++) {
+            hierarchy_free(&sweep->configs[i]);
+        }
+    }
+    free(sweep->configs);
+    free(sweep->batch);
+    free(sweep);
+}
@@ -22,4 +22,9 @@ src/utils/disasm.c: $(LIBCAPSTONE)
 $(LIBCAPSTONE):
 	$(MAKE) -C tools/capstone
 endif
+ifeq ($(CONFIG_CACHESIM),)
+SRCS-BLACKLIST-y += src/utils/cachesim.c
+else
+LIBS += -lpthread
+endif
 INC_PATH += $(NEMU_HOME)/tools/elf
@@ -2,32 +2,46 @@
 
 #ifdef CONFIG_ITRACE
 
-bool nemu_iringbuf_init(void) {
-    bool success;
+void disassemble(char *str, int size, uint64_t pc, uint8_t *code, int nbyte);
 
-    nemu_state.iringbuf = RingBuffer_create(NEMU_IRINGBUF_SIZE, &success);
-    return success;
-}
+void nemu_itrace_format(char *buf, int size, vaddr_t pc, const uint8_t *inst, int ilen) {
+    char *p = buf;
+    int i;
+
+    p += snprintf(p, size, "[itrace] " FMT_WORD ":", pc);
+#ifdef CONFIG_ISA_x86
+    for (i = 0; i < ilen; i ++) {
+#else
+    for (i = ilen - 1; i >= 0; i --) {
+#endif
+        p += snprintf(p, 4, " %02x", inst[i]);
+    }
+    int ilen_max = MUXDEF(CONFIG_ISA_x86, 8, 4);
+    int space_len = ilen_max - ilen;
+    if (space_len < 0) space_len = 0;
+    space_len = space_len * 3 + 1;
+    memset(p, ' ', space_len);
+    p += space_len;
 
-void nemu_iringbuf_destroy(void) {
-    RingBuffer_destroy(nemu_state.iringbuf);
+    disassemble(p, buf + size - p,
+        MUXDEF(CONFIG_ISA_x86, pc + ilen, pc), (uint8_t *) inst, ilen);
 }
 
 void nemu_iringbuf_dump(void) {
-    bstring bstr;
-    char *cstr;
-    bool success;
-
-    bstr = RingBuffer_gets_all(nemu_iringbuf, &success);
-    if (success) {
-        cstr = bstr2cstr(bstr, ' ');
-        printf("iringbuf data:\n");
-        printf("%s\n", cstr);
-        bcstrfree(cstr);
-        bdestroy(bstr);
-    } else {
-        printf("failed to get iringbuf data\n");
+    uint64_t end = nemu_state.iringbuf_count;
+    uint64_t begin = nemu_state.iringbuf_dumped;
+    char buf[128];
+
+    if (end - begin > NEMU_IRINGBUF_SIZE) {
+        begin = end - NEMU_IRINGBUF_SIZE;
+    }
+    printf("iringbuf data:\n");
+    for (uint64_t i = begin; i < end; i ++) {
+        IRingBufEntry *e = &nemu_iringbuf[i & (NEMU_IRINGBUF_SIZE - 1)];
+        nemu_itrace_format(buf, sizeof(buf), e->pc, e->inst, e->ilen);
+        printf("%s%s\n", i == end - 1 ? " --> " : "     ", buf);
     }
+    nemu_state.iringbuf_dumped = end;
 }
 
 #endif
@@ -0,0 +1,191 @@
+#include <common.h>
+#include <utils.h>
+
+#ifdef CONFIG_SAMPLER
+
+#define SAMPLER_TABLE_SIZE 4096
+#define SAMPLER_STACK_LEN 4096
+#define SAMPLER_MAX_FUNCS 1024
+#define SAMPLER_TABLE_ROWS 30
+
+/* 以调用栈（折叠成 "main;foo;bar" 的形式）为键的采样计数 */
+typedef struct {
+    char *stack;
+    uint64_t count;
+} StackEntry;
+
+/* 按函数汇总的采样计数 */
+typedef struct {
+    const char *name;
+    uint64_t self;
+    uint64_t total;
+} FuncEntry;
+
+static StackEntry stack_table[SAMPLER_TABLE_SIZE] = {};
+static size_t stack_table_size = 0;
+static uint64_t nr_samples = 0;
+static uint64_t nr_dropped = 0;
+
+static uint32_t hash_str(const char *s) {
+    uint32_t h = 2166136261u;
+    for (; *s; s++) {
+        h = (h ^ (uint8_t)*s) * 16777619u;
+    }
+    return h;
+}
+
+static const char *query_func_name(word_t addr) {
+    size_t i;
+    Symbol *sym;
+
+    for (i = 0; i < nemu_state.ftrace_func_syms_size; i++) {
+        sym = &nemu_state.ftrace_func_syms[i];
+        if (sym->addr <= addr && addr < sym->addr + sym->size) {
+            return sym->name;
+        }
+    }
+
+    return "<unknown>";
+}
+
+void sampler_sample(vaddr_t pc) {
+    char buf[SAMPLER_STACK_LEN];
+    char *p, *end;
+    const char *leaf;
+    size_t i, top;
+    uint32_t h;
+
+    p = buf;
+    end = buf + sizeof(buf);
+    *p = '\0';
+    top = nemu_state.ftrace_call_stack_top;
+    for (i = 0; i < top && p < end; i++) {
+        p += snprintf(p, end - p, "%s%s", i == 0 ? "" : ";", nemu_state.ftrace_call_stack[i].name);
+    }
+    // 栈顶函数通常就是 PC 所在的函数，若不是（如尚未识别到的调用）则补上
+    leaf = query_func_name(pc);
+    if (p < end && (top == 0 || strcmp(nemu_state.ftrace_call_stack[top - 1].name, leaf) != 0)) {
+        snprintf(p, end - p, "%s%s", top == 0 ? "" : ";", leaf);
+    }
+
+    nr_samples++;
+    h = hash_str(buf) % SAMPLER_TABLE_SIZE;
+    for (i = 0; i < SAMPLER_TABLE_SIZE; i++) {
+        StackEntry *e = &stack_table[(h + i) % SAMPLER_TABLE_SIZE];
+        if (e->stack == NULL) {
+            e->stack = strdup(buf);
+            e->count = 1;
+            stack_table_size++;
+            return;
+        }
+        if (strcmp(e->stack, buf) == 0) {
+            e->count++;
+            return;
+        }
+    }
+    // 哈希表已满，丢弃该样本
+    nr_dropped++;
+}
+
+static FuncEntry *find_func(FuncEntry *funcs, size_t *nr_funcs, const char *name, size_t len) {
+    size_t i;
+
+    for (i = 0; i < *nr_funcs; i++) {
+        if (strlen(funcs[i].name) == len && strncmp(funcs[i].name, name, len) == 0) {
+            return &funcs[i];
+        }
+    }
+    if (*nr_funcs == SAMPLER_MAX_FUNCS) {
+        return NULL;
+    }
+    funcs[*nr_funcs].name = strndup(name, len);
+    funcs[*nr_funcs].self = 0;
+    funcs[*nr_funcs].total = 0;
+    return &funcs[(*nr_funcs)++];
+}
+
+/* 判断 [name, name + len) 是否在 stack 的 [stack, end) 部分中作为完整的帧出现过 */
+static bool frame_seen(const char *stack, const char *end, const char *name, size_t len) {
+    const char *p, *q;
+
+    for (p = stack; p < end; p = q + 1) {
+        q = strchr(p, ';');
+        if (q == NULL || q > end) {
+            q = end;
+        }
+        if ((size_t)(q - p) == len && strncmp(p, name, len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int cmp_func_self(const void *a, const void *b) {
+    const FuncEntry *x = a, *y = b;
+    return x->self < y->self ? 1 : x->self > y->self ? -1 : strcmp(x->name, y->name);
+}
+
+void sampler_dump(void) {
+    static FuncEntry funcs[SAMPLER_MAX_FUNCS];
+    size_t nr_funcs, i;
+    FILE *fp;
+
+    if (nr_samples == 0) {
+        return;
+    }
+
+    // 输出折叠调用栈，可直接交给 flamegraph.pl 生成火焰图
+    fp = fopen(CONFIG_SAMPLER_OUT, "w");
+    if (fp == NULL) {
+        Log_info("Failed to open '%s' for folded stacks!", CONFIG_SAMPLER_OUT);
+    }
+
+    nr_funcs = 0;
+    for (i = 0; i < SAMPLER_TABLE_SIZE; i++) {
+        StackEntry *e = &stack_table[i];
+        const char *p, *q;
+        if (e->stack == NULL) {
+            continue;
+        }
+        if (fp) {
+            fprintf(fp, "%s %" PRIu64 "\n", e->stack, e->count * CONFIG_SAMPLER_INTERVAL);
+        }
+
+        // 每个函数在同一调用栈中只计一次总计数，以正确处理递归
+        for (p = e->stack; ; p = q + 1) {
+            FuncEntry *f;
+            q = strchr(p, ';');
+            if (q == NULL) {
+                q = p + strlen(p);
+            }
+            f = find_func(funcs, &nr_funcs, p, q - p);
+            if (f) {
+                if (!frame_seen(e->stack, p, p, q - p)) {
+                    f->total += e->count;
+                }
+                if (*q == '\0') {
+                    f->self += e->count;
+                }
+            }
+            if (*q == '\0') {
+                break;
+            }
+        }
+    }
+    if (fp) {
+        fclose(fp);
+        Log("folded stacks written to %s", CONFIG_SAMPLER_OUT);
+    }
+
+    qsort(funcs, nr_funcs, sizeof(FuncEntry), cmp_func_self);
+    Log("sampler: %" PRIu64 " samples, one every %d instructions, %" PRIu64 " dropped",
+        nr_samples, CONFIG_SAMPLER_INTERVAL, nr_dropped);
+    Log("%-32s %14s %7s %14s %7s", "function", "self insts", "self%", "total insts", "total%");
+    for (i = 0; i < nr_funcs && i < SAMPLER_TABLE_ROWS; i++) {
+        Log("%-32s %14" PRIu64 " %6.2f%% %14" PRIu64 " %6.2f%%", funcs[i].name,
+            funcs[i].self * CONFIG_SAMPLER_INTERVAL, funcs[i].self * 100.0 / nr_samples,
+            funcs[i].total * CONFIG_SAMPLER_INTERVAL, funcs[i].total * 100.0 / nr_samples);
+    }
+}
+
+#endif
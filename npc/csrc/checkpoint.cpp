@@ -0,0 +1,114 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <print>
+#include <cstring>
+#include <sim_top.hpp>
+#include <memory.hpp>
+#include <processor.hpp>
+#include <perf.hpp>
+#include <utils.hpp>
+#include <checkpoint.hpp>
+
+static ProcessorState checkpointState = {};
+static CheckpointHeader checkpointHeader = {};
+
+/**
+ * @brief 从检查点文件加载内容到主存中，并暂存其中的处理器状态。
+ *
+ * @param filename 文件名
+ * @param imgSize 镜像大小缓冲区，用以保存主存中被加载部分的大小
+ * @return true 成功
+ * @return false 失败
+ */
+bool checkpoint_load(const char *filename, size_t *imgSize) {
+    CheckpointHeader &header = checkpointHeader;
+    size_t size = 0;
+
+    std::ifstream f(filename, std::ios::binary);
+    if (!f) {
+        std::cerr << "无法打开检查点文件: " << filename << std::endl;
+        return false;
+    }
+
+    if (!f.read((char *) &header, sizeof(header)) ||
+        memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {
+        std::cerr << "不是有效的检查点文件: " << filename << std::endl;
+        return false;
+    }
+    if (header.stateSize != sizeof(ProcessorState)) {
+        std::cerr << "检查点中的处理器状态大小 (" << header.stateSize <<
+            ") 与仿真环境 (" << sizeof(ProcessorState) << ") 不一致!" << std::endl;
+        return false;
+    }
+    if (!f.read((char *) &checkpointState, sizeof(checkpointState))) {
+        std::cerr << "检查点文件不完整: " << filename << std::endl;
+        return false;
+    }
+
+    for (uint64_t i = 0; i < header.nrPages; i++) {
+        uint64_t paddr;
+        if (!f.read((char *) &paddr, sizeof(paddr)) ||
+            !isPhysMemoryAddr(paddr) ||
+            paddr - MEMORY_OFFSET + CHECKPOINT_PAGE_SIZE > PHYS_MEMORY_SIZE ||
+            !f.read((char *) &memory[paddr - MEMORY_OFFSET], CHECKPOINT_PAGE_SIZE)) {
+            std::cerr << "检查点文件中的内存页无效: " << filename << std::endl;
+            return false;
+        }
+        size = std::max(size, (size_t) (paddr - MEMORY_OFFSET + CHECKPOINT_PAGE_SIZE));
+    }
+
+    std::println("[checkpoint] 已加载区间 {} 的检查点: 第 {} 条指令, pc = {:#010x}, {} 个内存页",
+        header.interval, header.instCount, checkpointState.pc, header.nrPages);
+    if (imgSize) {
+        *imgSize = size;
+    }
+    return true;
+}
+
+/**
+ * @brief 处理器复位后调用，将检查点中的处理器状态注入处理器。
+ */
+void checkpoint_restore() {
+    setProcessorState(checkpointState);
+}
+
+/**
+ * @brief 依次仿真预热窗口与测量窗口，并输出测量窗口内的 IPC。
+ */
+void checkpoint_run() {
+    PerfCounters start;
+    uint64_t insts, cycles;
+    double ipc;
+
+    std::println("[checkpoint] 预热 {} 条指令...", sim_config.config_checkpointWarmup);
+    simExec(sim_config.config_checkpointWarmup);
+    if (sim_state.state != SIM_STOP) {
+        std::println("[checkpoint] 程序在预热窗口内结束，无法测量!");
+        return;
+    }
+
+    std::println("[checkpoint] 测量 {} 条指令...", sim_config.config_checkpointMeasure);
+    start = perf_counters;
+    simExec(sim_config.config_checkpointMeasure);
+    insts = perf_counters.instret - start.instret;
+    cycles = perf_counters.cycles - start.cycles;
+    ipc = cycles ? (double) insts / cycles : 0;
+    std::println("[checkpoint] 区间 {}: {} 条指令, {} 个周期, IPC = {:.4f}",
+        checkpointHeader.interval, insts, cycles, ipc);
+
+    if (!sim_config.config_checkpointResultFilePath.empty()) {
+        std::ofstream ofs(sim_config.config_checkpointResultFilePath, std::ios::app);
+        if (!ofs.is_open()) {
+            std::cerr << "[checkpoint] 无法打开测量结果输出文件 " <<
+                sim_config.config_checkpointResultFilePath << std::endl;
+            return;
+        }
+        ofs << std::format(
+            "{{\"checkpoint\": \"{}\", \"interval\": {}, \"warmup\": {}, "
+                "\"insts\": {}, \"cycles\": {}, \"ipc\": {:.6f}}}",
+            sim_config.config_checkpointFilePath, checkpointHeader.interval,
+            sim_config.config_checkpointWarmup, insts, cycles, ipc
+        ) << std::endl;
+    }
+}
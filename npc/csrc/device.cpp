@@ -20,6 +20,7 @@ void device_update() {
     lastUpdateTime = now;
 
     device_vga_updateScreen();
+    device_serial_flush();
 
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
@@ -45,3 +46,7 @@ void device_init() {
     device_vga_init();
     device_keyboard_init();
 }
+
+void device_finalise() {
+    device_serial_flush();
+}
@@ -1,4 +1,7 @@
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <string>
 #include <macro-def.hpp>
 #include <utils.hpp>
 #include <device/map.hpp>
@@ -6,11 +9,41 @@
 
 #define CH_OFFSET 0
 
+// TX FIFO：程序先以字为单位写满突发缓冲区，再向门铃寄存器写入有效字节数，一次性发送
+#define TX_SIZE_OFFSET  0x000
+#define TX_COUNT_OFFSET 0x004
+#define TX_BUF_OFFSET   0x400
+#define TX_BUF_SIZE     0x400
+#define TX_SPACE_SIZE   (TX_BUF_OFFSET + TX_BUF_SIZE)
+
+// 主机侧输出缓冲区大小，遇到换行、缓冲区满或定时器到期时才真正写出
+#define HOST_BUF_SIZE 4096
+
 static void *serial_base = nullptr;
+static uint8_t *serial_tx_base = nullptr;
+static std::string hostBuf;
 
-static void serial_putc(char ch) {
-    std::cerr.put(ch);
+/**
+ * @brief 将串口输出缓冲区中的内容写到主机的标准错误输出。
+ */
+void device_serial_flush() {
+    if (hostBuf.empty()) {
+        return;
+    }
+    std::cerr.write(hostBuf.data(), hostBuf.size());
     std::flush(std::cerr);
+    hostBuf.clear();
+}
+
+static void serial_write(const char *buf, size_t len) {
+    hostBuf.append(buf, len);
+    if (hostBuf.size() >= HOST_BUF_SIZE || std::memchr(buf, '\n', len)) {
+        device_serial_flush();
+    }
+}
+
+static void serial_putc(char ch) {
+    serial_write(&ch, 1);
 }
 
 static void serial_io_handler(uint32_t offset, int len, bool isWrite) {
@@ -31,10 +64,28 @@ static void serial_io_handler(uint32_t offset, int len, bool isWrite) {
     }
 }
 
+static void serial_tx_io_handler(uint32_t offset, int len, bool isWrite) {
+    uint32_t count;
+
+    if (!isWrite || offset != TX_COUNT_OFFSET) {
+        return;
+    }
+    count = memoryHostRead(serial_tx_base + TX_COUNT_OFFSET, 4);
+    serial_write((const char *) serial_tx_base + TX_BUF_OFFSET, std::min(count, (uint32_t) TX_BUF_SIZE));
+}
+
 void device_serial_init() {
     serial_base = device_map_newSpace(8);
     device_map_addMMIOMap(
         "serial", SERIAL_MMIO_ADDR, serial_base,
         8, serial_io_handler
     );
+
+    serial_tx_base = device_map_newSpace(TX_SPACE_SIZE);
+    memoryHostWrite(serial_tx_base + TX_SIZE_OFFSET, 4, TX_BUF_SIZE);
+    device_map_addMMIOMap(
+        "serial-tx", SERIAL_TX_MMIO_ADDR, serial_tx_base,
+        TX_SPACE_SIZE, serial_tx_io_handler
+    );
+    hostBuf.reserve(HOST_BUF_SIZE);
 }
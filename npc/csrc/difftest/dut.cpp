@@ -132,6 +132,16 @@ void difftest_dut_step(addr_t pc, addr_t npc) {
     checkregs(&refState, pc);
 }
 
+void difftest_dut_fastForward(uint64_t n, ProcessorState *state) {
+    std::println("[difftest] 正在让 REF 快进 {} 条指令...", n);
+    ref_difftest_exec(n);
+
+    std::println("[difftest] 正在将 REF 的主存与处理器状态同步回 DUT...");
+    ref_difftest_memcpy(MEMORY_OFFSET, memory, PHYS_MEMORY_SIZE, DIFFTEST_TO_DUT);
+    ref_difftest_regcpy(state, DIFFTEST_TO_DUT);
+    std::println("[difftest] 快进完毕! pc = {:#010x}", state->pc);
+}
+
 void difftest_dut_syncCurrentProcessorState() {
     ProcessorState state = getProcessorState();
     ref_difftest_regcpy(&state, DIFFTEST_TO_REF);
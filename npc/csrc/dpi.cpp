@@ -1,20 +1,52 @@
 #include <iostream>
 #include <iomanip>
 #include <cstdint>
+#include <atomic>
+#include <bit>
 #include <format>
 #include <print>
 #include <sim_top.hpp>
 #include <memory.hpp>
 #include <utils.hpp>
 #include <utils/Stage.hpp>
+#include <utils/profiler.hpp>
 
-extern "C" void dpi_halt(bool halt) {
-    sim_halt = halt;
+/*
+ * DPIAdapter 将各触发信号的电平打包为一个事件字，在其变化时通过唯一的 DPI 函数 dpi_onEvents 送出。
+ * 多线程编译（--threads）时该函数可能由 Verilator 的工作线程在 eval() 中途调用，
+ * 此时其余顶层端口尚未稳定，因此它只原子地保存事件字；
+ * 待 eval() 返回后再由主线程调用 dpi_dispatch()，与上一次的事件字比较得到本次发生的事件，
+ * 查表调用对应的处理函数，由处理函数读取顶层端口上的其余信息。
+ * 事件字的布局须与 DPIAdapter.sv 一致，位序即处理顺序（写主存先于读主存）。
+ */
+enum DPIEvent : uint32_t {
+    DPI_EVENT_INST_JAL,
+    DPI_EVENT_INST_JALR,
+    DPI_EVENT_ECALL,
+    DPI_EVENT_MEM_WRITE,
+    DPI_EVENT_MEM_READ,
+    DPI_EVENT_HALT,
+    DPI_EVENT_STAGE,    // 虚拟事件：阶段发生变化
+    NR_DPI_EVENT
+};
 
-    if (sim_halt) {
-        if (sim_config.config_debugOutput)
-            std::cout << "[sim] 仿真环境置仿真终止信号，处理器下一次执行前将结束仿真！" << std::endl;
-    }
+#define DPI_EVENT_LEVEL_MASK ((1u << DPI_EVENT_STAGE) - 1)
+#define DPI_EVENT_STAGE_SHIFT DPI_EVENT_STAGE
+#define DPI_EVENT_STAGE_MASK (0b111u << DPI_EVENT_STAGE_SHIFT)
+
+typedef void (*DPIHandler)();
+
+static std::atomic<uint32_t> dpiEventWord{0};
+static uint32_t lastEventWord = 0;
+static DPIHandler dpiHandlers[NR_DPI_EVENT] = {};
+// 已启用处理函数的事件，未启用的跟踪类型不产生任何开销
+static uint32_t dpiEnabledEvents = 0;
+
+static void handleHalt() {
+    sim_halt = true;
+
+    if (sim_config.config_debugOutput)
+        std::cout << "[sim] 仿真环境置仿真终止信号，处理器下一次执行前将结束仿真！" << std::endl;
 }
 
 static bool isAddrFuncSymStart(addr_t addr) {
@@ -42,14 +74,14 @@ static bool tryRecord(CallType type, addr_t pc, addr_t destAddr) {
     return result;
 }
 
-extern "C" void dpi_onInst_jal(bool _trig) {
+static void handleInstJal() {
     bool trig = top->ioDPI_inst_jal;
     // 检测是否触发该指令，未触发则不执行操作
     if (!trig) {
         return;
     }
 
-    if (sim_config.config_ftrace) {
+    if (sim_config.config_ftrace || sim_config.config_sampler) {
         word_t imm;
         uint8_t rd;
         addr_t pc, destAddr;
@@ -72,14 +104,14 @@ extern "C" void dpi_onInst_jal(bool _trig) {
     }
 }
 
-extern "C" void dpi_onInst_jalr(bool _trig) {
+static void handleInstJalr() {
     bool trig = top->ioDPI_inst_jalr;
     // 检测是否触发该指令，未触发则不执行操作
     if (!trig) {
         return;
     }
 
-    if (sim_config.config_ftrace) {
+    if (sim_config.config_ftrace || sim_config.config_sampler) {
         word_t src1, imm;
         uint8_t rd, rs1;
         addr_t pc, destAddr;
@@ -140,7 +172,7 @@ static size_t dataStrobeToSize(uint8_t dataStrobe) {
     return 0;
 }
 
-extern "C" void dpi_onMemWriteEnable(bool _memWriteEnable) {
+static void handleMemWriteEnable() {
     addr_t addr;
     word_t data;
 
@@ -182,7 +214,7 @@ extern "C" void dpi_onMemWriteEnable(bool _memWriteEnable) {
     }
 }
 
-extern "C" void dpi_onMemReadEnable(bool _memReadEnable) {
+static void handleMemReadEnable() {
     addr_t addr;
     word_t data;
     
@@ -227,7 +259,7 @@ extern "C" void dpi_onMemReadEnable(bool _memReadEnable) {
     }
 }
 
-extern "C" void dpi_onStage(uint8_t _stage) {
+static void handleStage() {
     uint8_t stage = top->ioDPI_stage;
 
     if (sim_config.config_debugOutput) {
@@ -257,7 +289,7 @@ extern "C" void dpi_onStage(uint8_t _stage) {
     }
 }
 
-extern "C" void dpi_onEcallEnable(bool _ecallEnable) {
+static void handleEcallEnable() {
     bool ecallEnable = top->ioDPI_ecallEnable;
     if (ecallEnable && sim_config.config_etrace) {
         // 记录 etrace
@@ -268,3 +300,74 @@ extern "C" void dpi_onEcallEnable(bool _ecallEnable) {
         }
     }
 }
+
+/**
+ * @brief 按配置建立 DPI 事件的处理函数表，须在仿真开始前调用。
+ */
+void dpi_init() {
+    dpiHandlers[DPI_EVENT_MEM_WRITE] = handleMemWriteEnable;
+    dpiHandlers[DPI_EVENT_MEM_READ] = handleMemReadEnable;
+    dpiHandlers[DPI_EVENT_HALT] = handleHalt;
+    // 采样器同样需要 ftrace 维护的调用栈
+    if (sim_config.config_ftrace || sim_config.config_sampler) {
+        dpiHandlers[DPI_EVENT_INST_JAL] = handleInstJal;
+        dpiHandlers[DPI_EVENT_INST_JALR] = handleInstJalr;
+    }
+    if (sim_config.config_etrace) {
+        dpiHandlers[DPI_EVENT_ECALL] = handleEcallEnable;
+    }
+    if (sim_config.config_debugOutput) {
+        dpiHandlers[DPI_EVENT_STAGE] = handleStage;
+    }
+
+    dpiEnabledEvents = 0;
+    for (uint32_t i = 0; i < NR_DPI_EVENT; i++) {
+        if (dpiHandlers[i]) {
+            dpiEnabledEvents |= 1u << i;
+        }
+    }
+}
+
+/**
+ * @brief 处理 eval() 期间发生的 DPI 事件，须在 eval() 返回后由主线程调用。
+ */
+void dpi_dispatch() {
+    uint32_t word = dpiEventWord.load(std::memory_order_acquire);
+    uint32_t events;
+
+    if (word == lastEventWord) {
+        return;
+    }
+    // 电平信号取上升沿，阶段信号取任意变化
+    events = word & ~lastEventWord & DPI_EVENT_LEVEL_MASK;
+    if ((word ^ lastEventWord) & DPI_EVENT_STAGE_MASK) {
+        events |= 1u << DPI_EVENT_STAGE;
+    }
+    lastEventWord = word;
+
+    events &= dpiEnabledEvents;
+    if (!events) {
+        return;
+    }
+    ProfilerScope profilerScope(PROF_DPI);
+    do {
+        dpiHandlers[std::countr_zero(events)]();
+        events &= events - 1;
+    } while (events);
+}
+
+/**
+ * @brief 丢弃 eval() 期间发生的 DPI 事件，用于只为输出波形而重新仿真的场合。
+ */
+void dpi_discard() {
+    lastEventWord = dpiEventWord.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief DPIAdapter 中各触发信号的电平变化时调用。
+ *
+ * @param events 打包后的事件字
+ */
+extern "C" void dpi_onEvents(uint32_t events) {
+    dpiEventWord.store(events, std::memory_order_release);
+}
@@ -3,6 +3,7 @@
 #include <iomanip>
 #include <sim_top.hpp>
 #include <isa.hpp>
+#include <perf.hpp>
 
 #ifdef CONFIG_RVE
 static const char *regs[] = {
@@ -107,8 +108,8 @@ word_t isaRegStr2Val(const char *s, bool *success) {
         }
     }
 
-    *success = false;
-    return 0;
+    // 处理器尚未实现计数器 CSR，由仿真环境的性能计数器代为提供
+    return perf_csrStr2Val(s, success);
 }
 
 /**
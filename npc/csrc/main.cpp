@@ -4,6 +4,7 @@
 #include <sim_top.hpp>
 #include <memory.hpp>
 #include <utils.hpp>
+#include <checkpoint.hpp>
 
 VerilatedContext *verContext = nullptr;
 
@@ -67,6 +68,18 @@ static void loadConfig() {
         std::cout << "[config] 调试信息输出已启用" << std::endl;
     }
 
+    env = std::getenv("NPC_CONFIG_PROFILE");
+    sim_config.config_profile = env && strcmp(env, "on") == 0;
+    if (sim_config.config_profile) {
+        std::cout << "[config] 性能分析已启用" << std::endl;
+    }
+
+    env = std::getenv("NPC_CONFIG_SAMPLER");
+    sim_config.config_sampler = env && strcmp(env, "on") == 0;
+    if (sim_config.config_sampler) {
+        std::cout << "[config] PC 采样分析已启用" << std::endl;
+    }
+
     env = std::getenv("NPC_CONFIG_DIFFTEST_PORT");
     try {
         sim_config.config_difftestPort = env ? std::stoi(env) : 0;
@@ -78,6 +91,183 @@ static void loadConfig() {
         sim_config.config_difftestPort = DEFAULT_DIFFTEST_PORT;
     }
 
+    env = std::getenv("NPC_CONFIG_PROFILE_INTERVAL");
+    if (env) {
+        try {
+            sim_config.config_profileInterval = std::stoull(env);
+            std::cout << "[config] 性能分析报告间隔已指定为 " <<
+                std::dec << sim_config.config_profileInterval << " 条指令" << std::endl;
+        } catch (const std::exception &e) {
+            std::cout << "[config] 性能分析报告间隔设置失败！将使用默认间隔 " <<
+                std::dec << DEFAULT_PROFILE_INTERVAL << " 条指令" << std::endl;
+            sim_config.config_profileInterval = DEFAULT_PROFILE_INTERVAL;
+        }
+    }
+
+    env = std::getenv("NPC_CONFIG_PERF_CSV_INTERVAL");
+    if (env) {
+        try {
+            sim_config.config_perfCsvInterval = std::stoull(env);
+            std::cout << "[config] 性能计数器 CSV 输出间隔已指定为 " <<
+                std::dec << sim_config.config_perfCsvInterval << " 条指令" << std::endl;
+        } catch (const std::exception &e) {
+            std::cout << "[config] 性能计数器 CSV 输出间隔设置失败！将使用默认间隔 " <<
+                std::dec << DEFAULT_PERF_CSV_INTERVAL << " 条指令" << std::endl;
+            sim_config.config_perfCsvInterval = DEFAULT_PERF_CSV_INTERVAL;
+        }
+    }
+
+    env = std::getenv("NPC_CONFIG_SAMPLER_INTERVAL");
+    if (env) {
+        try {
+            sim_config.config_samplerInterval = std::stoull(env);
+            if (sim_config.config_samplerInterval == 0) {
+                throw std::invalid_argument("zero interval");
+            }
+            std::cout << "[config] PC 采样间隔已指定为 " <<
+                std::dec << sim_config.config_samplerInterval << " 条指令" << std::endl;
+        } catch (const std::exception &e) {
+            std::cout << "[config] PC 采样间隔设置失败！将使用默认间隔 " <<
+                std::dec << DEFAULT_SAMPLER_INTERVAL << " 条指令" << std::endl;
+            sim_config.config_samplerInterval = DEFAULT_SAMPLER_INTERVAL;
+        }
+    }
+
+    env = std::getenv("NPC_CONFIG_CHECKPOINT_WARMUP");
+    if (env) {
+        try {
+            sim_config.config_checkpointWarmup = std::stoull(env);
+            std::cout << "[config] 检查点预热窗口已指定为 " <<
+                std::dec << sim_config.config_checkpointWarmup << " 条指令" << std::endl;
+        } catch (const std::exception &e) {
+            std::cout << "[config] 检查点预热窗口设置失败！将使用默认窗口 " <<
+                std::dec << DEFAULT_CHECKPOINT_WARMUP << " 条指令" << std::endl;
+            sim_config.config_checkpointWarmup = DEFAULT_CHECKPOINT_WARMUP;
+        }
+    }
+
+    env = std::getenv("NPC_CONFIG_CHECKPOINT_MEASURE");
+    if (env) {
+        try {
+            sim_config.config_checkpointMeasure = std::stoull(env);
+            std::cout << "[config] 检查点测量窗口已指定为 " <<
+                std::dec << sim_config.config_checkpointMeasure << " 条指令" << std::endl;
+        } catch (const std::exception &e) {
+            std::cout << "[config] 检查点测量窗口设置失败！将使用默认窗口 " <<
+                std::dec << DEFAULT_CHECKPOINT_MEASURE << " 条指令" << std::endl;
+            sim_config.config_checkpointMeasure = DEFAULT_CHECKPOINT_MEASURE;
+        }
+    }
+
+    env = std::getenv("NPC_CONFIG_FASTFORWARD");
+    if (env) {
+        try {
+            sim_config.config_fastForward = std::stoull(env);
+            std::cout << "[config] 将先由 REF 快进 " <<
+                std::dec << sim_config.config_fastForward << " 条指令" << std::endl;
+        } catch (const std::exception &e) {
+            std::cout << "[config] 快进指令数设置失败！将不进行快进" << std::endl;
+            sim_config.config_fastForward = 0;
+        }
+    }
+
+    env = std::getenv("NPC_CONFIG_WAVE_TRIGGER_WATCHPOINT");
+    sim_config.config_waveWatchpoint = env && strcmp(env, "on") == 0;
+    if (sim_config.config_waveWatchpoint) {
+        std::cout << "[config] 监视点触发时将记录波形" << std::endl;
+    }
+
+    env = std::getenv("NPC_CONFIG_WAVE_START_CYCLE");
+    if (env) {
+        try {
+            sim_config.config_waveStartCycle = std::stoull(env);
+            if (sim_config.config_waveStartCycle) {
+                std::cout << "[config] 将从第 " <<
+                    std::dec << sim_config.config_waveStartCycle << " 个周期开始记录波形" << std::endl;
+            }
+        } catch (const std::exception &e) {
+            std::cout << "[config] 波形记录起始周期设置失败！将从复位开始记录" << std::endl;
+            sim_config.config_waveStartCycle = 0;
+        }
+    }
+
+    env = std::getenv("NPC_CONFIG_WAVE_END_CYCLE");
+    if (env) {
+        try {
+            sim_config.config_waveEndCycle = std::stoull(env);
+            if (sim_config.config_waveEndCycle) {
+                std::cout << "[config] 将在第 " <<
+                    std::dec << sim_config.config_waveEndCycle << " 个周期停止记录波形" << std::endl;
+            }
+        } catch (const std::exception &e) {
+            std::cout << "[config] 波形记录结束周期设置失败！将记录到仿真结束" << std::endl;
+            sim_config.config_waveEndCycle = 0;
+        }
+    }
+
+    env = std::getenv("NPC_CONFIG_WAVE_TRIGGER_PC");
+    if (env) {
+        try {
+            sim_config.config_waveTriggerPC = std::stoull(env, nullptr, 0);
+            if (sim_config.config_waveTriggerPC) {
+                std::cout << "[config] PC 为 0x" << std::hex <<
+                    sim_config.config_waveTriggerPC << std::dec << " 时将触发波形记录" << std::endl;
+            }
+        } catch (const std::exception &e) {
+            std::cout << "[config] 波形记录触发 PC 设置失败！将不按 PC 触发" << std::endl;
+            sim_config.config_waveTriggerPC = 0;
+        }
+    }
+
+    env = std::getenv("NPC_CONFIG_WAVE_WINDOW");
+    if (env) {
+        try {
+            sim_config.config_waveWindow = std::stoull(env);
+            if (sim_config.config_waveWindow) {
+                std::cout << "[config] 每次触发后记录 " <<
+                    std::dec << sim_config.config_waveWindow << " 个周期的波形" << std::endl;
+            }
+        } catch (const std::exception &e) {
+            std::cout << "[config] 波形记录窗口设置失败！触发后将一直记录" << std::endl;
+            sim_config.config_waveWindow = 0;
+        }
+    }
+
+    env = std::getenv("NPC_CONFIG_WAVE_FLIGHT");
+    if (env) {
+        if (strcmp(env, "on") == 0) {
+            sim_config.config_waveFlight = DEFAULT_WAVE_FLIGHT;
+        } else {
+            try {
+                sim_config.config_waveFlight = strcmp(env, "off") == 0 ? 0 : std::stoull(env);
+            } catch (const std::exception &e) {
+                std::cout << "[config] 飞行记录快照间隔设置失败！将使用默认间隔 " <<
+                    std::dec << DEFAULT_WAVE_FLIGHT << " 个周期" << std::endl;
+                sim_config.config_waveFlight = DEFAULT_WAVE_FLIGHT;
+            }
+        }
+        if (sim_config.config_waveFlight) {
+            std::cout << "[config] 波形飞行记录已启用，快照间隔为 " <<
+                std::dec << sim_config.config_waveFlight << " 个周期" << std::endl;
+        }
+    }
+
+    env = std::getenv("NPC_CONFIG_CACHESIM_THREADS");
+    if (env) {
+        try {
+            sim_config.config_cacheSimThreads = std::stoi(env);
+            if (sim_config.config_cacheSimThreads <= 0) {
+                throw std::invalid_argument("non-positive threads");
+            }
+            std::cout << "[config] 缓存模拟线程数已指定为 " <<
+                std::dec << sim_config.config_cacheSimThreads << std::endl;
+        } catch (const std::exception &e) {
+            std::cout << "[config] 缓存模拟线程数设置失败！将使用默认线程数 " <<
+                std::dec << DEFAULT_CACHESIM_THREADS << std::endl;
+            sim_config.config_cacheSimThreads = DEFAULT_CACHESIM_THREADS;
+        }
+    }
+
     env = std::getenv("NPC_CONFIG_ITRACE_OUT_FILE_PATH");
     if (env) {
         sim_config.config_itraceOutFilePath =
@@ -141,6 +331,70 @@ static void loadConfig() {
         std::cout << "[config] 波形文件输出路径已指定为: " <<
             sim_config.config_waveFilePath << std::endl;
     }
+
+    env = std::getenv("NPC_CONFIG_PROFILE_JSON_FILE_PATH");
+    if (env) {
+        sim_config.config_profileJsonFilePath =
+            std::move(std::string(env));
+        std::cout << "[config] 性能分析 JSON 输出路径已指定为: " <<
+            sim_config.config_profileJsonFilePath << std::endl;
+    }
+
+    env = std::getenv("NPC_CONFIG_PERF_CSV_FILE_PATH");
+    if (env) {
+        sim_config.config_perfCsvFilePath =
+            std::move(std::string(env));
+        std::cout << "[config] 性能计数器 CSV 输出路径已指定为: " <<
+            sim_config.config_perfCsvFilePath << std::endl;
+    }
+
+    env = std::getenv("NPC_CONFIG_SAMPLER_OUT_FILE_PATH");
+    if (env) {
+        sim_config.config_samplerOutFilePath =
+            std::move(std::string(env));
+        std::cout << "[config] PC 采样折叠调用栈输出路径已指定为: " <<
+            sim_config.config_samplerOutFilePath << std::endl;
+    }
+
+    env = std::getenv("NPC_CONFIG_CHECKPOINT_FILE_PATH");
+    if (env) {
+        sim_config.config_checkpointFilePath =
+            std::move(std::string(env));
+        std::cout << "[config] 检查点文件路径已指定为: " <<
+            sim_config.config_checkpointFilePath << std::endl;
+    }
+
+    env = std::getenv("NPC_CONFIG_CHECKPOINT_RESULT_FILE_PATH");
+    if (env) {
+        sim_config.config_checkpointResultFilePath =
+            std::move(std::string(env));
+        std::cout << "[config] 检查点测量结果输出路径已指定为: " <<
+            sim_config.config_checkpointResultFilePath << std::endl;
+    }
+
+    env = std::getenv("NPC_CONFIG_CACHESIM");
+    if (env) {
+        sim_config.config_cacheSimConfigs =
+            std::move(std::string(env));
+        std::cout << "[config] 缓存模拟配置已指定为: " <<
+            sim_config.config_cacheSimConfigs << std::endl;
+    }
+
+    env = std::getenv("NPC_CONFIG_MEMMODEL");
+    if (env) {
+        sim_config.config_memModelConfigs =
+            std::move(std::string(env));
+        std::cout << "[config] 主存时序模型配置已指定为: " <<
+            sim_config.config_memModelConfigs << std::endl;
+    }
+
+    env = std::getenv("NPC_CONFIG_MEMMODEL_STATS_FILE_PATH");
+    if (env) {
+        sim_config.config_memModelStatsFilePath =
+            std::move(std::string(env));
+        std::cout << "[config] 主存时序模型统计输出路径已指定为: " <<
+            sim_config.config_memModelStatsFilePath << std::endl;
+    }
 }
 
 /**
@@ -154,6 +408,10 @@ static bool checkRequiredConfig() {
         std::cerr << "未指定 NPC_CONFIG_ELF_FILE_PATH 环境变量, 请指定二进制文件路径!" << std::endl;
         return false;
     }
+    if (sim_config.config_fastForward > 0 && !sim_config.config_difftest) {
+        std::cerr << "快进需要借助 DiffTest 的 REF 完成, 请同时开启 NPC_CONFIG_DIFFTEST!" << std::endl;
+        return false;
+    }
 
     return true;
 }
@@ -194,13 +452,22 @@ int main(int argc, const char *argv[]) {
         return EXIT_FAILURE;
     }
 
-    std::cout << "正在加载二进制文件到主存..." << std::endl;
-    if (!initMemory(binPath, &binFileSize)) {
-        std::cerr << "二进制文件加载失败，退出..." << std::endl;
-        return EXIT_FAILURE;
+    if (!sim_config.config_checkpointFilePath.empty()) {
+        // 从检查点恢复时，主存内容全部来自检查点
+        std::cout << "正在加载检查点到主存..." << std::endl;
+        if (!checkpoint_load(sim_config.config_checkpointFilePath.c_str(), &binFileSize)) {
+            std::cerr << "检查点加载失败，退出..." << std::endl;
+            return EXIT_FAILURE;
+        }
+    } else {
+        std::cout << "正在加载二进制文件到主存..." << std::endl;
+        if (!initMemory(binPath, &binFileSize)) {
+            std::cerr << "二进制文件加载失败，退出..." << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "二进制文件加载成功，大小为 " <<
+            std::dec << binFileSize << " 字节" << std::endl;
     }
-    std::cout << "二进制文件加载成功，大小为 " <<
-        std::dec << binFileSize << " 字节" << std::endl;
 
     result = simulate(sdb);
 
@@ -0,0 +1,463 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <print>
+#include <string>
+#include <vector>
+#include <queue>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <bit>
+#include <utils.hpp>
+#include <perf.hpp>
+#include <memory.hpp>
+#include <memmodel.hpp>
+
+enum MemRegionKind {
+    MEM_REGION_SRAM,
+    MEM_REGION_DRAM,
+    MEM_REGION_MMIO
+};
+
+// 须与 MemRegionKind 的顺序一致
+static const char *regionKindNames[] = {
+    "sram",
+    "dram",
+    "mmio"
+};
+
+/**
+ * @brief 每个区域的统计数据。
+ */
+struct MemRegionStats {
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t fetches;
+    /**
+     * @brief 所有访问从发出到完成的周期数之和，包括排队等待的部分。
+     */
+    uint64_t totalLatency;
+    uint64_t maxLatency;
+    /**
+     * @brief 读与取指使处理器阻塞的周期数。
+     */
+    uint64_t stallCycles;
+    /**
+     * @brief 因目标存储体仍被占用而推迟的访问次数。
+     */
+    uint64_t bankConflicts;
+    uint64_t rowHits;
+    uint64_t rowMisses;
+    /**
+     * @brief 因未完成请求数已达上限而推迟的访问次数。
+     */
+    uint64_t outstandingStalls;
+};
+
+struct MemRegion {
+    MemRegionKind kind;
+    uint64_t start;
+    /**
+     * @brief 结束地址，不包含在区域内，可以为 4GB。
+     */
+    uint64_t end;
+
+    uint64_t lat;
+    uint64_t jitter;
+    uint64_t banks;
+    uint64_t interleave;
+    uint64_t bankBusy;
+    uint64_t rowSize;
+    uint64_t rowHit;
+    uint64_t rowMiss;
+    uint64_t outstanding;
+
+    /**
+     * @brief 各存储体空闲下来的时刻。
+     */
+    std::vector<uint64_t> bankFreeAt;
+    /**
+     * @brief 各存储体当前打开的行，-1 表示没有打开的行。
+     */
+    std::vector<int64_t> openRow;
+    /**
+     * @brief 未完成请求的完成时刻，最早的在堆顶。
+     */
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> inflight;
+
+    MemRegionStats stats;
+};
+
+enum MemAccessType {
+    MEM_ACCESS_READ,
+    MEM_ACCESS_WRITE,
+    MEM_ACCESS_FETCH
+};
+
+static std::vector<MemRegion> regions;
+static uint64_t totalStallCycles = 0;
+// 固定种子，保证同一配置下多次运行的结果一致
+static std::mt19937_64 rng(0x5eed);
+
+/**
+ * @brief 当前时刻：处理器实际运行的周期数加上时序模型累计的阻塞周期数。
+ */
+static inline uint64_t currentTime() {
+    return perf_counters.cycles + totalStallCycles;
+}
+
+static MemRegion *findRegion(addr_t addr) {
+    for (auto &region : regions) {
+        if (addr >= region.start && addr < region.end) {
+            return &region;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 计算一次访问的完成时刻，更新区域状态与统计数据，读与取指时累计阻塞周期。
+ */
+static void access(MemRegion &region, addr_t addr, MemAccessType type) {
+    MemRegionStats &stats = region.stats;
+    uint64_t now = currentTime();
+    uint64_t start = now;
+    uint64_t lat;
+
+    switch (type) {
+        case MEM_ACCESS_READ:
+            stats.reads++;
+            break;
+        case MEM_ACCESS_WRITE:
+            stats.writes++;
+            break;
+        case MEM_ACCESS_FETCH:
+            stats.fetches++;
+            break;
+    }
+
+    while (!region.inflight.empty() && region.inflight.top() <= start) {
+        region.inflight.pop();
+    }
+    if (region.outstanding && region.inflight.size() >= region.outstanding) {
+        // 等待最早的一个请求完成
+        stats.outstandingStalls++;
+        start = region.inflight.top();
+        region.inflight.pop();
+    }
+
+    uint64_t offset = addr - region.start;
+    uint64_t bank = (offset / region.interleave) & (region.banks - 1);
+    if (region.bankFreeAt[bank] > start) {
+        stats.bankConflicts++;
+        start = region.bankFreeAt[bank];
+    }
+
+    if (region.kind == MEM_REGION_DRAM) {
+        int64_t row = offset / region.rowSize;
+        if (region.openRow[bank] == row) {
+            stats.rowHits++;
+            lat = region.rowHit;
+        } else {
+            stats.rowMisses++;
+            lat = region.rowMiss;
+            region.openRow[bank] = row;
+        }
+    } else {
+        lat = region.lat;
+    }
+    if (region.jitter) {
+        lat += rng() % (region.jitter + 1);
+    }
+
+    uint64_t done = start + lat;
+    region.bankFreeAt[bank] = start + (region.bankBusy ? region.bankBusy : lat);
+    region.inflight.push(done);
+
+    stats.totalLatency += done - now;
+    stats.maxLatency = std::max(stats.maxLatency, done - now);
+    // 处理器本身已为每次访问花费一个周期，超出的部分记为阻塞
+    if (type != MEM_ACCESS_WRITE && done > now + 1) {
+        stats.stallCycles += done - now - 1;
+        totalStallCycles += done - now - 1;
+    }
+}
+
+/**
+ * @brief 主存时序模型后端，计时后把访问原样交给下一级后端完成。
+ */
+class MemModelBackend final : public MemoryBackend {
+public:
+    explicit MemModelBackend(MemoryBackend *next) : next(next) {}
+
+    const char *name() const override {
+        return "memmodel";
+    }
+
+    word_t read(addr_t addr, int len) override {
+        MemRegion *region = findRegion(addr);
+        if (region) {
+            access(*region, addr, MEM_ACCESS_READ);
+        }
+        return next->read(addr, len);
+    }
+
+    void write(addr_t addr, int len, word_t data) override {
+        MemRegion *region = findRegion(addr);
+        if (region) {
+            access(*region, addr, MEM_ACCESS_WRITE);
+        }
+        next->write(addr, len, data);
+    }
+
+    word_t fetch(addr_t addr) override {
+        MemRegion *region = findRegion(addr);
+        if (region) {
+            access(*region, addr, MEM_ACCESS_FETCH);
+        }
+        return next->fetch(addr);
+    }
+
+    const uint8_t *hostPage(addr_t) override {
+        // 每次取指都要计时，不能经由取指缓存直接读取
+        return nullptr;
+    }
+
+private:
+    MemoryBackend *next;
+};
+
+static MemModelBackend *modelBackend = nullptr;
+
+static void setRegionDefaults(MemRegion &region) {
+    region.lat = 0;
+    region.jitter = 0;
+    region.banks = 1;
+    region.interleave = 0;
+    region.bankBusy = 0;
+    region.rowSize = 0;
+    region.rowHit = 0;
+    region.rowMiss = 0;
+    region.outstanding = 0;
+    switch (region.kind) {
+        case MEM_REGION_SRAM:
+            region.lat = 1;
+            break;
+        case MEM_REGION_DRAM:
+            region.banks = 8;
+            region.rowSize = 2048;
+            region.rowHit = 14;
+            region.rowMiss = 40;
+            region.outstanding = 4;
+            break;
+        case MEM_REGION_MMIO:
+            region.lat = 10;
+            region.outstanding = 1;
+            break;
+    }
+}
+
+static bool parseNumber(const std::string &str, uint64_t *val) {
+    try {
+        size_t pos;
+        *val = std::stoull(str, &pos, 0);
+        return pos == str.length();
+    } catch (...) {
+        return false;
+    }
+}
+
+static bool parseOption(MemRegion &region, const std::string &opt) {
+    size_t eq = opt.find('=');
+    uint64_t val;
+
+    if (eq == std::string::npos || !parseNumber(opt.substr(eq + 1), &val)) {
+        return false;
+    }
+    std::string key = opt.substr(0, eq);
+    if (key == "lat") {
+        region.lat = val;
+    } else if (key == "jitter") {
+        region.jitter = val;
+    } else if (key == "banks") {
+        region.banks = val;
+    } else if (key == "interleave") {
+        region.interleave = val;
+    } else if (key == "bankbusy") {
+        region.bankBusy = val;
+    } else if (key == "row") {
+        region.rowSize = val;
+    } else if (key == "rowhit") {
+        region.rowHit = val;
+    } else if (key == "rowmiss") {
+        region.rowMiss = val;
+    } else if (key == "out") {
+        region.outstanding = val;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static std::vector<std::string> split(const std::string &str, char sep) {
+    std::vector<std::string> parts;
+    size_t begin = 0;
+
+    while (true) {
+        size_t pos = str.find(sep, begin);
+        parts.push_back(str.substr(begin, pos - begin));
+        if (pos == std::string::npos) {
+            break;
+        }
+        begin = pos + 1;
+    }
+    return parts;
+}
+
+/**
+ * @brief 解析一个区域的配置，格式见 memmodel.hpp。
+ */
+static bool parseRegion(const std::string &str, MemRegion &region) {
+    std::vector<std::string> fields = split(str, ':');
+    uint64_t start, end;
+
+    if (fields.size() < 2 || fields.size() > 3) {
+        return false;
+    }
+    auto kind = std::find(std::begin(regionKindNames), std::end(regionKindNames), fields[0]);
+    if (kind == std::end(regionKindNames)) {
+        return false;
+    }
+    region.kind = (MemRegionKind) (kind - std::begin(regionKindNames));
+    setRegionDefaults(region);
+
+    size_t dash = fields[1].find('-');
+    if (dash == std::string::npos ||
+        !parseNumber(fields[1].substr(0, dash), &start) ||
+        !parseNumber(fields[1].substr(dash + 1), &end) ||
+        start >= end || end > (uint64_t) UINT32_MAX + 1) {
+        return false;
+    }
+    region.start = start;
+    region.end = end;
+
+    if (fields.size() == 3) {
+        for (const auto &opt : split(fields[2], ',')) {
+            if (!opt.empty() && !parseOption(region, opt)) {
+                return false;
+            }
+        }
+    }
+
+    if (region.interleave == 0) {
+        region.interleave = region.kind == MEM_REGION_DRAM ? region.rowSize : 4;
+    }
+    if (region.banks == 0 || !std::has_single_bit(region.banks) ||
+        !std::has_single_bit(region.interleave)) {
+        return false;
+    }
+    if (region.kind == MEM_REGION_DRAM && region.rowSize == 0) {
+        return false;
+    }
+    region.bankFreeAt.assign(region.banks, 0);
+    region.openRow.assign(region.banks, -1);
+    region.stats = {};
+    return true;
+}
+
+bool memmodel_init() {
+    if (sim_config.config_memModelConfigs.empty()) {
+        return true;
+    }
+    for (const auto &str : split(sim_config.config_memModelConfigs, ';')) {
+        if (str.empty()) {
+            continue;
+        }
+        MemRegion region;
+        if (!parseRegion(str, region)) {
+            std::cerr << "[memmodel] 无法解析区域配置: " << str << std::endl;
+            regions.clear();
+            return false;
+        }
+        regions.push_back(std::move(region));
+    }
+
+    modelBackend = new MemModelBackend(getMemoryBackend());
+    setMemoryBackend(modelBackend);
+    for (const auto &region : regions) {
+        std::println("[memmodel] {} [{:#010x}, {:#010x}) banks={} out={}",
+            regionKindNames[region.kind], region.start, region.end,
+            region.banks, region.outstanding);
+    }
+    return true;
+}
+
+uint64_t memmodel_stallCycles() {
+    return totalStallCycles;
+}
+
+static void writeJson(uint64_t cycles, uint64_t insts) {
+    std::ofstream ofs(sim_config.config_memModelStatsFilePath);
+
+    if (!ofs) {
+        std::cerr << "[memmodel] 无法写入统计文件 " <<
+            sim_config.config_memModelStatsFilePath << std::endl;
+        return;
+    }
+    ofs << std::format("{{\n  \"cycles\": {},\n  \"stallCycles\": {},\n  \"instret\": {},\n",
+        cycles, totalStallCycles, insts);
+    ofs << "  \"regions\": [";
+    for (size_t i = 0; i < regions.size(); i++) {
+        const MemRegion &region = regions[i];
+        const MemRegionStats &s = region.stats;
+        ofs << (i ? ",\n" : "\n");
+        ofs << std::format("    {{\"kind\": \"{}\", \"start\": {}, \"end\": {}, "
+            "\"reads\": {}, \"writes\": {}, \"fetches\": {}, "
+            "\"totalLatency\": {}, \"maxLatency\": {}, \"stallCycles\": {}, "
+            "\"bankConflicts\": {}, \"rowHits\": {}, \"rowMisses\": {}, "
+            "\"outstandingStalls\": {}}}",
+            regionKindNames[region.kind], region.start, region.end,
+            s.reads, s.writes, s.fetches,
+            s.totalLatency, s.maxLatency, s.stallCycles,
+            s.bankConflicts, s.rowHits, s.rowMisses, s.outstandingStalls);
+    }
+    ofs << "\n  ]\n}\n";
+}
+
+void memmodel_report(uint64_t cycles, uint64_t insts) {
+    if (modelBackend == nullptr) {
+        return;
+    }
+
+    uint64_t effCycles = cycles + totalStallCycles;
+    std::println("Memory model:");
+    for (const auto &region : regions) {
+        const MemRegionStats &s = region.stats;
+        uint64_t accesses = s.reads + s.writes + s.fetches;
+        std::println("  {} [{:#010x}, {:#010x}):", regionKindNames[region.kind],
+            region.start, region.end);
+        std::println("    reads {} writes {} fetches {}", s.reads, s.writes, s.fetches);
+        std::println("    avg latency {:.2f} max latency {} stall cycles {}",
+            accesses ? (double) s.totalLatency / accesses : 0, s.maxLatency, s.stallCycles);
+        std::println("    bank conflicts {} outstanding stalls {}",
+            s.bankConflicts, s.outstandingStalls);
+        if (region.kind == MEM_REGION_DRAM) {
+            std::println("    row hits {} row misses {} hit rate {:.2f}%", s.rowHits, s.rowMisses,
+                s.rowHits + s.rowMisses ?
+                    (double) s.rowHits / (s.rowHits + s.rowMisses) * 100 : 0);
+        }
+    }
+    std::println("  cycles:    {} (core) + {} (stall) = {}", cycles, totalStallCycles, effCycles);
+    std::println("  IPC:       {:.4f} (core {:.4f})",
+        effCycles ? (double) insts / effCycles : 0,
+        cycles ? (double) insts / cycles : 0);
+
+    if (!sim_config.config_memModelStatsFilePath.empty()) {
+        writeJson(cycles, insts);
+    }
+
+    setMemoryBackend(nullptr);
+    delete modelBackend;
+    modelBackend = nullptr;
+}
@@ -1,11 +1,15 @@
 #include <iostream>
 #include <fstream>
+#include <cstring>
 #include <utils.hpp>
 #include <device/mmio.hpp>
 #include <memory.hpp>
+#include <utils/cachesim.h>
 
 uint8_t memory[PHYS_MEMORY_SIZE] = { 0 };
 
+static CacheSweep *cacheSim = nullptr;
+
 /**
  * @brief 从给定二进制文件（bin）加载内容到主存中。
  * 
@@ -40,6 +44,160 @@ bool initMemory(const char *filename, size_t *fileSize) {
     return true;
 }
 
+/**
+ * @brief 按 sim_config 中的配置创建缓存模拟器，未配置时不做任何事。
+ *
+ * @return true 成功
+ * @return false 缓存配置有误
+ */
+bool initCacheSim() {
+    if (sim_config.config_cacheSimConfigs.empty()) {
+        return true;
+    }
+    cacheSim = cachesim_create(sim_config.config_cacheSimConfigs.c_str(),
+        sim_config.config_cacheSimThreads);
+    return cacheSim != nullptr;
+}
+
+/**
+ * @brief 输出缓存模拟器的统计结果。
+ *
+ * @param insts 期间执行的指令数，用于计算 MPKI
+ */
+void reportCacheSim(uint64_t insts) {
+    if (cacheSim == nullptr) {
+        return;
+    }
+    cachesim_report(cacheSim, insts, [](const char *line) {
+        std::cout << line << std::endl;
+    });
+    cachesim_destroy(cacheSim);
+    cacheSim = nullptr;
+}
+
+/**
+ * @brief 默认的主存后端：物理主存直接映射到主机数组 memory，其余地址交给 MMIO 设备。
+ */
+class FlatMemoryBackend final : public MemoryBackend {
+public:
+    const char *name() const override {
+        return "flat";
+    }
+
+    word_t read(addr_t addr, int len) override {
+        if (isPhysMemoryAddr(addr)) {
+            return memoryHostRead(&memory[addr - MEMORY_OFFSET], len);
+        }
+        return device_mmio_read(addr, len);
+    }
+
+    void write(addr_t addr, int len, word_t data) override {
+        if (isPhysMemoryAddr(addr)) {
+            memoryHostWrite(&memory[addr - MEMORY_OFFSET], len, data);
+            return;
+        }
+        device_mmio_write(addr, len, data);
+    }
+
+    const uint8_t *hostPage(addr_t addr) override {
+        if (!isPhysMemoryAddr(addr)) {
+            return nullptr;
+        }
+        return &memory[(addr - MEMORY_OFFSET) & ~(addr_t) PAGE_MASK];
+    }
+};
+
+static FlatMemoryBackend flatBackend;
+static MemoryBackend *backend = &flatBackend;
+
+/*
+ * 取指缓存：以页号直接映射，命中时直接从主机地址读取指令，
+ * 省去地址范围检查与后端调用。写入某页时使对应项失效，更换后端时全部清空。
+ */
+#define FETCH_CACHE_SIZE 64
+#define FETCH_CACHE_INVALID ((addr_t) -1)
+
+struct FetchCacheEntry {
+    addr_t page = FETCH_CACHE_INVALID;
+    const uint8_t *host = nullptr;
+};
+
+static FetchCacheEntry fetchCache[FETCH_CACHE_SIZE];
+
+static inline FetchCacheEntry &fetchCacheEntry(addr_t page) {
+    return fetchCache[page & (FETCH_CACHE_SIZE - 1)];
+}
+
+static void flushFetchCache() {
+    for (auto &entry : fetchCache) {
+        entry.page = FETCH_CACHE_INVALID;
+        entry.host = nullptr;
+    }
+}
+
+static inline void invalidateFetchPage(addr_t addr) {
+    FetchCacheEntry &entry = fetchCacheEntry(addr >> PAGE_SHIFT);
+    if (entry.page == addr >> PAGE_SHIFT) {
+        entry.page = FETCH_CACHE_INVALID;
+    }
+}
+
+static word_t fetchSlow(addr_t addr) {
+    const uint8_t *host = backend->hostPage(addr);
+
+    if (host && (addr & 3) == 0) {
+        FetchCacheEntry &entry = fetchCacheEntry(addr >> PAGE_SHIFT);
+        entry.page = addr >> PAGE_SHIFT;
+        entry.host = host;
+        return memoryHostRead(host + (addr & PAGE_MASK), 4);
+    }
+    return backend->fetch(addr);
+}
+
+/**
+ * @brief 取指的快速路径：对齐且命中取指缓存时只需一次查表与一次 32 位读。
+ */
+static inline word_t fetchFast(addr_t addr) {
+    const FetchCacheEntry &entry = fetchCacheEntry(addr >> PAGE_SHIFT);
+    if (entry.page == addr >> PAGE_SHIFT && (addr & 3) == 0) [[likely]] {
+        return memoryHostRead(entry.host + (addr & PAGE_MASK), 4);
+    }
+    return fetchSlow(addr);
+}
+
+/**
+ * @brief 更换主存后端，并清空取指缓存。传入 nullptr 时恢复为默认的直接映射后端。
+ *
+ * @param newBackend 新的主存后端，由调用者负责其生命周期
+ */
+void setMemoryBackend(MemoryBackend *newBackend) {
+    backend = newBackend ? newBackend : &flatBackend;
+    flushFetchCache();
+    std::cout << "[memory] 主存后端: " << backend->name() << std::endl;
+}
+
+/**
+ * @brief 返回当前的主存后端。
+ */
+MemoryBackend *getMemoryBackend() {
+    return backend;
+}
+
+/**
+ * @brief 从主存中取指令，与 readMemory 的区别在于缓存模拟器将其计入指令缓存。
+ *
+ * @param addr 主存地址（包含了内存地址偏移的）
+ * @return word_t 读取到的指令
+ */
+word_t fetchMemory(addr_t addr) {
+    if (cacheSim) [[unlikely]] {
+        if (isPhysMemoryAddr(addr)) {
+            cachesim_access(cacheSim, addr, sizeof(word_t), CACHE_ACCESS_IFETCH);
+        }
+    }
+    return fetchFast(addr);
+}
+
 /**
  * @brief 从主存中读取内容。
  * 
@@ -48,26 +206,23 @@ bool initMemory(const char *filename, size_t *fileSize) {
  * @return word_t 读取到的内容
  */
 word_t readMemory(addr_t addr, int len) {
-    uint32_t result;
-
-    result = 0;
-
-    if (isPhysMemoryAddr(addr)) {
-        Assert(len == 1 || len == 2 || len == 4, "Invalid memory read length");
-
-        result |= memory[addr - MEMORY_OFFSET];
-        if (len >= 2) {
-            result |= memory[addr - MEMORY_OFFSET + 1] << 8;
-        }
-        if (len >= 4) {
-            result |= memory[addr - MEMORY_OFFSET + 2] << 16;
-            result |= memory[addr - MEMORY_OFFSET + 3] << 24;
-        }
-        return result;
+    // 设备访问不经过缓存
+    if (cacheSim && isPhysMemoryAddr(addr)) {
+        cachesim_access(cacheSim, addr, len, CACHE_ACCESS_READ);
     }
+    return backend->read(addr, len);
+}
 
-    result = device_mmio_read(addr, len);
-    return result;
+/**
+ * @brief 供调试器（SDB 的 x 命令与表达式求值）读取主存或设备。
+ * 不经过主存时序模型等后端，也不计入缓存模拟器，以免调试操作影响统计结果。
+ *
+ * @param addr 主存地址（包含了内存地址偏移的）
+ * @param len 读取长度（单位为字节）
+ * @return word_t 读取到的内容
+ */
+word_t debugReadMemory(addr_t addr, int len) {
+    return flatBackend.read(addr, len);
 }
 
 /**
@@ -78,18 +233,12 @@ word_t readMemory(addr_t addr, int len) {
  * @param data 将要写入的内容
  */
 void writeMemory(addr_t addr, int len, word_t data) {
-    word_t val;
-    size_t i;
-
-    val = data;
-
     if (isPhysMemoryAddr(addr)) {
-        for (i = 0; i < len; i++) {
-            memory[addr - MEMORY_OFFSET + i] = val & 0xFF;
-            val >>= 8;
+        if (cacheSim) {
+            cachesim_access(cacheSim, addr, len, CACHE_ACCESS_WRITE);
         }
-        return;
+        invalidateFetchPage(addr);
+        invalidateFetchPage(addr + len - 1);
     }
-    
-    device_mmio_write(addr, len, val);
+    backend->write(addr, len, data);
 }
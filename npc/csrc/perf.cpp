@@ -0,0 +1,269 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <print>
+#include <string>
+#include <cstring>
+#include <utils.hpp>
+#include <perf.hpp>
+
+PerfCounters perf_counters = {};
+
+uint8_t perf_lastStage = STAGE_IF;
+
+// 须与 PerfInstClass 的顺序一致
+static const char *instClassNames[NR_PERF_INST_CLASS] = {
+    "alu",
+    "load",
+    "store",
+    "branchTaken",
+    "branchNotTaken",
+    "jump",
+    "csr",
+    "ecall",
+    "other"
+};
+
+// 须与 Stage 的顺序一致
+static const char *stageNames[] = {
+    "IF",
+    "ID",
+    "EX",
+    "MA",
+    "WB",
+    "UPC"
+};
+#define NR_STAGE ARRLEN(stageNames)
+
+/**
+ * @brief 尚未确定是否跳转的条件分支指令的 PC。
+ */
+static addr_t pendingBranchPC = 0;
+static bool hasPendingBranch = false;
+
+static std::ofstream csvOfs;
+static uint64_t nextCsvInsts = UINT64_MAX;
+
+/**
+ * @brief 以 mhpmcounter3 起依次编号的计数器。
+ */
+static uint64_t *const hpmCounters[] = {
+    &perf_counters.memStallCycles,
+    &perf_counters.instClass[PERF_INST_LOAD],
+    &perf_counters.instClass[PERF_INST_STORE],
+    &perf_counters.instClass[PERF_INST_BRANCH_TAKEN],
+    &perf_counters.instClass[PERF_INST_BRANCH_NOT_TAKEN],
+    &perf_counters.instClass[PERF_INST_JUMP],
+    &perf_counters.instClass[PERF_INST_CSR],
+    &perf_counters.instClass[PERF_INST_ECALL],
+    &perf_counters.instClass[PERF_INST_ALU]
+};
+#define HPM_COUNTER_BASE 3
+
+/**
+ * @brief 每条指令取指时调用。条件分支是否跳转要等到下一条指令取指时才能确定。
+ *
+ * @param pc 本次取指的 PC
+ */
+void perf_onFetch(addr_t pc) {
+    if (hasPendingBranch) {
+        perf_counters.instClass[pc == pendingBranchPC + 4 ?
+            PERF_INST_BRANCH_NOT_TAKEN : PERF_INST_BRANCH_TAKEN]++;
+        hasPendingBranch = false;
+    }
+}
+
+/**
+ * @brief 每条指令提交后调用，按类别统计该指令。
+ *
+ * @param pc 该指令的 PC
+ * @param inst 该指令
+ */
+void perf_onRetire(addr_t pc, word_t inst) {
+    uint32_t opcode = inst & 0x7f;
+    uint32_t funct3 = (inst >> 12) & 0x7;
+    PerfInstClass cls;
+
+    perf_counters.instret++;
+    switch (opcode) {
+        case 0b0110011: // OP
+        case 0b0010011: // OP-IMM
+        case 0b0110111: // LUI
+        case 0b0010111: // AUIPC
+            cls = PERF_INST_ALU;
+            break;
+        case 0b0000011: // LOAD
+            cls = PERF_INST_LOAD;
+            break;
+        case 0b0100011: // STORE
+            cls = PERF_INST_STORE;
+            break;
+        case 0b1100011: // BRANCH
+            pendingBranchPC = pc;
+            hasPendingBranch = true;
+            return;
+        case 0b1101111: // JAL
+        case 0b1100111: // JALR
+            cls = PERF_INST_JUMP;
+            break;
+        case 0b1110011: // SYSTEM
+            if (funct3 != 0) {
+                cls = PERF_INST_CSR;
+            } else if (inst == 0x00000073) {
+                cls = PERF_INST_ECALL;
+            } else {
+                cls = PERF_INST_OTHER;
+            }
+            break;
+        default:
+            cls = PERF_INST_OTHER;
+    }
+    perf_counters.instClass[cls]++;
+}
+
+static void writeCsvHeader() {
+    csvOfs << "instret,cycles";
+    for (int i = 0; i < NR_STAGE; i++) {
+        csvOfs << "," << stageNames[i];
+    }
+    csvOfs << ",memStall";
+    for (int i = 0; i < NR_PERF_INST_CLASS; i++) {
+        csvOfs << "," << instClassNames[i];
+    }
+    csvOfs << ",ipc" << std::endl;
+}
+
+static void writeCsvLine() {
+    const PerfCounters &c = perf_counters;
+
+    csvOfs << c.instret << "," << c.cycles;
+    for (int i = 0; i < NR_STAGE; i++) {
+        csvOfs << "," << c.stageCycles[i];
+    }
+    csvOfs << "," << c.memStallCycles;
+    for (int i = 0; i < NR_PERF_INST_CLASS; i++) {
+        csvOfs << "," << c.instClass[i];
+    }
+    csvOfs << "," << std::format("{:.4f}", c.cycles ? (double) c.instret / c.cycles : 0) <<
+        std::endl;
+}
+
+/**
+ * @brief 初始化性能计数器的 CSV 输出。需提前确保 sim_config 中相关配置信息已正确填入。
+ */
+void perf_init() {
+    if (sim_config.config_perfCsvFilePath.empty()) {
+        return;
+    }
+
+    csvOfs.open(sim_config.config_perfCsvFilePath);
+    if (!csvOfs.is_open()) {
+        std::cerr << "[perf] 无法打开 CSV 输出文件 " <<
+            sim_config.config_perfCsvFilePath << std::endl;
+        return;
+    }
+    writeCsvHeader();
+    nextCsvInsts = sim_config.config_perfCsvInterval > 0 ?
+        sim_config.config_perfCsvInterval : UINT64_MAX;
+}
+
+/**
+ * @brief 每执行完一条指令后调用，达到输出间隔时向 CSV 文件追加一行。
+ */
+void perf_tick() {
+    if (perf_counters.instret < nextCsvInsts) {
+        return;
+    }
+    writeCsvLine();
+    nextCsvInsts += sim_config.config_perfCsvInterval;
+}
+
+/**
+ * @brief 将所有性能计数器及 IPC、CPI 打印到标准输出。
+ */
+void perf_display() {
+    const PerfCounters &c = perf_counters;
+
+    std::println("Performance counters:");
+    std::println("  cycles:    {}", c.cycles);
+    std::println("  instret:   {}", c.instret);
+    std::println("  IPC:       {:.4f}", c.cycles ? (double) c.instret / c.cycles : 0);
+    std::println("  CPI:       {:.4f}", c.instret ? (double) c.cycles / c.instret : 0);
+    std::println("Cycles per stage:");
+    for (int i = 0; i < NR_STAGE; i++) {
+        std::println("  {:<16} {:>14} {:>6.2f}%", stageNames[i], c.stageCycles[i],
+            c.cycles ? (double) c.stageCycles[i] / c.cycles * 100 : 0);
+    }
+    std::println("  {:<16} {:>14} {:>6.2f}%", "memStall", c.memStallCycles,
+        c.cycles ? (double) c.memStallCycles / c.cycles * 100 : 0);
+    std::println("Retired instructions:");
+    for (int i = 0; i < NR_PERF_INST_CLASS; i++) {
+        std::println("  {:<16} {:>14} {:>6.2f}%", instClassNames[i], c.instClass[i],
+            c.instret ? (double) c.instClass[i] / c.instret * 100 : 0);
+    }
+}
+
+/**
+ * @brief 清零所有性能计数器，用于排除复位期间的时钟周期。
+ */
+void perf_reset() {
+    perf_counters = {};
+    perf_lastStage = STAGE_IF;
+    hasPendingBranch = false;
+}
+
+/**
+ * @brief 确定最后一条条件分支是否跳转，然后关闭性能计数器的 CSV 输出，并追加最后一行。
+ *
+ * @param pc 仿真结束时处理器的 PC，即下一条指令取指的 PC
+ */
+void perf_finalise(addr_t pc) {
+    perf_onFetch(pc);
+    if (csvOfs.is_open()) {
+        writeCsvLine();
+        csvOfs.close();
+    }
+}
+
+/**
+ * @brief 以 CSR 的形式读取性能计数器，如 mcycle、minstret、mhpmcounter3 等。
+ *
+ * @param name CSR 名称
+ * @param success 操作是否成功
+ * @return word_t 计数器的值；若不存在该 CSR 则返回0
+ */
+word_t perf_csrStr2Val(const char *name, bool *success) {
+    std::string str(name);
+    bool high = false;
+    uint64_t val;
+
+    // RV32 中高 32 位由带 h 后缀的 CSR 读出
+    if (sizeof(word_t) == 4 && str.length() > 1 && str.back() == 'h') {
+        high = true;
+        str.pop_back();
+    }
+
+    *success = true;
+    if (str == "mcycle" || str == "cycle") {
+        val = perf_counters.cycles;
+    } else if (str == "minstret" || str == "instret") {
+        val = perf_counters.instret;
+    } else if (str.starts_with("mhpmcounter")) {
+        int idx;
+        try {
+            idx = std::stoi(str.substr(strlen("mhpmcounter"))) - HPM_COUNTER_BASE;
+        } catch (const std::exception &e) {
+            idx = -1;
+        }
+        if (idx < 0 || idx >= ARRLEN(hpmCounters)) {
+            *success = false;
+            return 0;
+        }
+        val = *hpmCounters[idx];
+    } else {
+        *success = false;
+        return 0;
+    }
+
+    return high ? (word_t) (val >> 32) : (word_t) val;
+}
@@ -2,6 +2,7 @@
 #include <iomanip>
 #include <format>
 #include <utility>
+#include <algorithm>
 #include <sim_top.hpp>
 #include <isa.hpp>
 #include <processor.hpp>
@@ -91,3 +92,61 @@ ProcessorState getProcessorState() {
     state.csr[CSR_MTVAL] = top->ioDPI_csr_mtval;
     return std::move(state);
 };
+
+/**
+ * @brief 不经主存，直接向处理器注入一条指令并执行。
+ * 
+ * @param inst 指令
+ */
+static void injectInst(word_t inst) {
+    top->io_instData = inst;
+    simStep();
+}
+
+/**
+ * @brief 注入 lui + addi 两条指令，将立即数载入寄存器。
+ * 
+ * @param rd 目的寄存器
+ * @param val 立即数
+ */
+static void injectLoadImm(int rd, word_t val) {
+    word_t hi = (val + 0x800) & ~0xfffu;
+    word_t lo = val & 0xfff;
+
+    injectInst(hi | (rd << 7) | 0b0110111);
+    injectInst((lo << 20) | (rd << 15) | (rd << 7) | 0b0010011);
+}
+
+/**
+ * @brief 将仿真环境的处理器设置为给定状态。处理器刚复位时调用。
+ *
+ * 处理器并未提供直接写寄存器的接口，因此通过向处理器注入一段指令序列实现：
+ * 先借助 x1 用 csrrw 写入各 CSR，再用 lui + addi 写入各通用寄存器，
+ * 最后用若干条 jal 跳转到目标 PC（每条 jal 至多跳转 1MB）。
+ * 
+ * @param state 处理器状态
+ */
+void setProcessorState(const ProcessorState &state) {
+    static const uint32_t csrs[] = {
+        CSR_MSTATUS, CSR_MTVEC, CSR_MEPC, CSR_MCAUSE, CSR_MTVAL
+    };
+    const int64_t jalMax = (1 << 20) - 4;
+    int i;
+
+    for (uint32_t csr : csrs) {
+        injectLoadImm(1, state.csr[csr]);
+        // csrrw x0, csr, x1
+        injectInst((csr << 20) | (1 << 15) | (0b001 << 12) | 0b1110011);
+    }
+    for (i = 1; i < RISCV_GPR_NUM; i++) {
+        injectLoadImm(i, state.gpr[i]);
+    }
+    while (top->io_pc != state.pc) {
+        int64_t off = (int64_t) state.pc - (int64_t) top->io_pc;
+        off = std::clamp(off, -jalMax, jalMax);
+        word_t imm = (word_t) off;
+        // jal x0, off
+        injectInst((((imm >> 20) & 0x1) << 31) | (((imm >> 1) & 0x3ff) << 21) |
+            (((imm >> 11) & 0x1) << 20) | (((imm >> 12) & 0xff) << 12) | 0b1101111);
+    }
+}
@@ -10,6 +10,8 @@
 #include <sim_top.hpp>
 #include <utils.hpp>
 #include <sdb.hpp>
+#include <perf.hpp>
+#include <wave.hpp>
 
 #define NR_WP 32
 
@@ -231,7 +233,7 @@ public:
                 success = false;
                 return 0;
             }
-            int64_t val = readMemory((addr_t) mem_addr, sizeof(word_t));
+            int64_t val = debugReadMemory((addr_t) mem_addr, sizeof(word_t));
             success = true;
             return val;
         } else if (checkParentheses(p, q)) {
@@ -485,12 +487,14 @@ static int cmd_si(char *args) {
  * 
  * 打印寄存器状态
  * 打印监视点信息
+ * 打印性能计数器
  * 
  * 格式：info SUBCMD
  * 
  * 使用举例：
  * info r
  * info w
+ * info perf
  * 
  * @param args
  * @return int 始终返回0
@@ -503,6 +507,9 @@ static int cmd_info(char *args) {
         } else if (strcmp(args, "w") == 0) {
             printWPPool();
             return 0;
+        } else if (strcmp(args, "perf") == 0) {
+            perf_display();
+            return 0;
         }
     }
     printBadArguments();
@@ -550,7 +557,7 @@ static int cmd_x(char *args) {
     printf("Memory scan: addr=0x%08x, N=%d\n", addr, N);
     cur_addr = addr;
     for (i = 0; i < N; i++) {
-        value = readMemory(cur_addr, sizeof(word_t));
+        value = debugReadMemory(cur_addr, sizeof(word_t));
         printf("0x%08X: %08X\n", cur_addr, value);
         cur_addr += 4;
     }
@@ -664,6 +671,41 @@ static int cmd_d(char *args) {
     return 0;
 }
 
+/**
+ * @brief 控制波形记录
+ * 
+ * wave on 开始记录波形（记录 NPC_CONFIG_WAVE_WINDOW 个周期，为 0 则直到 wave off）
+ * wave off 停止记录波形
+ * wave dump 飞行记录模式下，输出截至当前周期的最近一段波形
+ * 
+ * 格式：wave SUBCMD
+ * 
+ * 使用举例：wave dump
+ * 
+ * @param args 
+ * @return int 始终返回0
+ */
+static int cmd_wave(char *args) {
+    if (!sim_config.config_wave) {
+        std::cout << "未开启波形记录 (NPC_CONFIG_WAVE)！" << std::endl;
+        return 0;
+    }
+    if (args) {
+        if (strcmp(args, "on") == 0) {
+            wave_trigger("SDB 命令");
+            return 0;
+        } else if (strcmp(args, "off") == 0) {
+            wave_stop();
+            return 0;
+        } else if (strcmp(args, "dump") == 0) {
+            wave_flightDump();
+            return 0;
+        }
+    }
+    printBadArguments();
+    return 0;
+}
+
 static struct {
     const char *name;
     const char *description;
@@ -673,11 +715,12 @@ static struct {
     { "c", "Continue the execution of the program", cmd_c },
     { "q", "Exit simulation", cmd_q },
     { "si", "Run the given number of instructions of the program and pause", cmd_si },
-    { "info", "Display information about registers or watchpoints", cmd_info },
+    { "info", "Display information about registers, watchpoints or performance counters", cmd_info },
     { "x", "Display the contents of memory", cmd_x },
     { "p", "Evaluate an expression and display the result", cmd_p },
     { "w", "Set a watchpoint on an expression", cmd_w },
-    { "d", "Delete a watchpoint", cmd_d }
+    { "d", "Delete a watchpoint", cmd_d },
+    { "wave", "Start, stop or dump waveform recording", cmd_wave }
 };
 
 #define NR_CMD ARRLEN(cmd_table)
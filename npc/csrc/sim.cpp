@@ -1,4 +1,3 @@
-#include <verilated_fst_c.h>
 #include <iostream>
 #include <fstream>
 #include <cstdint>
@@ -8,11 +7,18 @@
 #include <sim_top.hpp>
 #include <utils.hpp>
 #include <memory.hpp>
+#include <memmodel.hpp>
 #include <sdb.hpp>
+#include <wave.hpp>
 #include <difftest/dut.hpp>
 #include <device.hpp>
 #include <utils/Stage.hpp>
 #include <utils/timer.hpp>
+#include <utils/profiler.hpp>
+#include <perf.hpp>
+#include <utils/sampler.hpp>
+#include <checkpoint.hpp>
+#include <processor.hpp>
 
 ExecInfo simExecInfo = {
     .pc = 0x00000000,
@@ -20,29 +26,36 @@ ExecInfo simExecInfo = {
 };
 
 VProcessorCore *top = nullptr;
-static VerilatedFstC *tfp = nullptr;
 bool sim_halt = false;
 
-static uint32_t execCount = 0;
+static uint64_t execCount = 0;
 
 /**
  * @brief 执行一步仿真，执行一个时钟周期。
  */
 void simStep() {
+    ProfilerPhase prevPhase = profiler_enter(PROF_EVAL);
     do {
         top->clock = 0;
         top->eval();
-        if (tfp) {
-            verContext->timeInc(1);
-            tfp->dump(verContext->time());
+        // 须在处理 DPI 事件之前记录，此时处理器的输入仍是本次 eval() 所用的值
+        if (sim_config.config_wave) {
+            profiler_enter(PROF_WAVE);
+            wave_onEval();
+            profiler_enter(PROF_EVAL);
         }
+        dpi_dispatch();
+        perf_onCycle(top->ioDPI_stage);
         top->clock = 1;
         top->eval();
-        if (tfp) {
-            verContext->timeInc(1);
-            tfp->dump(verContext->time());
+        if (sim_config.config_wave) {
+            profiler_enter(PROF_WAVE);
+            wave_onEval();
+            profiler_enter(PROF_EVAL);
         }
+        dpi_dispatch();
     } while (top->ioDPI_stage != STAGE_IF);
+    profiler_enter(prevPhase);
 }
 
 /**
@@ -69,12 +82,14 @@ bool simExecOnce() {
         std::cout << "处理器第 " << std::dec << execCount << " 次执行 (从 0 开始算)..." << std::endl;
 
     simExecInfo.pc = top->io_pc;
+    perf_onFetch(simExecInfo.pc);
     if (sim_config.config_debugOutput)
         std::cout << "当前PC: 0x" << std::setfill('0') <<
             std::setw(8) << std::hex << simExecInfo.pc << std::endl;
 
     // 若开启了 difftest, 执行前要先向 REF 同步处理器状态.
     if (sim_config.config_difftest) {
+        ProfilerScope scope(PROF_DIFFTEST);
         difftest_dut_syncCurrentProcessorState();
     }
 
@@ -84,7 +99,9 @@ bool simExecOnce() {
         std::cout << "正在从内存中读指令..." << std::endl;
     addr = top->io_pc;
     if (addr >= MEMORY_OFFSET) {
-        data = readMemory(addr, sizeof(word_t));
+        profiler_enter(PROF_FETCH);
+        data = fetchMemory(addr);
+        profiler_enter(PROF_HARNESS);
         if (sim_config.config_debugOutput)
             std::cout << "地址: 0x" << std::setfill('0') <<
                 std::setw(8) << std::hex << addr <<
@@ -104,33 +121,19 @@ bool simExecOnce() {
     simStep();
 
     execCount++;
+    perf_onRetire(simExecInfo.pc, simExecInfo.inst);
+
+    // 环形缓冲区常开，只记录 PC 与指令，输出时才反汇编
+    sim_state.itrace_iringbuf.push({ simExecInfo.pc, simExecInfo.inst });
 
     if (sim_config.config_itrace) {
         char pbuf[128];
-        char *p = pbuf;
-        p += snprintf(p, sizeof(pbuf), FMT_WORD ":", simExecInfo.pc);
-        int ilen = 4; // TODO: 等实现 RV32C 指令集后需修改此处（RV32C单条指令长度为2）
-        int i;
-        uint8_t *inst = (uint8_t *) &simExecInfo.inst;
-        for (i = ilen - 1; i >= 0; i--) {
-            p += snprintf(p, 4, " %02x", inst[i]);
-        }
-        int ilen_max = 4;
-        int space_len = ilen_max - ilen;
-        space_len = std::max(space_len, 0);
-        space_len = space_len * 3 + 1;
-        memset(p, ' ', space_len);
-        p += space_len;
-        disasm_disassemble(p, pbuf + sizeof(pbuf) - p, simExecInfo.pc, inst, ilen);
+        profiler_enter(PROF_DISASM);
+        disasm_formatITrace(pbuf, sizeof(pbuf), simExecInfo.pc, simExecInfo.inst);
+        profiler_enter(PROF_LOG);
 
         std::string str(pbuf);
         str += "\n";
-        auto *iringbuf = sim_state.itrace_iringbuf;
-        if (str.length() > iringbuf->availableSpace()) {
-            iringbuf->discard(str.length(), true);
-        }
-        iringbuf->write(str);
-
         sim_state.itrace_ofs << str;
         std::flush(sim_state.itrace_ofs);
 
@@ -138,6 +141,7 @@ bool simExecOnce() {
             std::cout << str;
             std::flush(std::cout);
         }
+        profiler_enter(PROF_HARNESS);
     }
 
     return true;
@@ -148,8 +152,10 @@ bool simExecOnce() {
  */
 static void traceAndDiffTest() {
     if (sim_config.config_difftest) {
+        ProfilerScope scope(PROF_DIFFTEST);
         difftest_dut_step(simExecInfo.pc, top->io_pc);
     }
+    ProfilerScope scope(PROF_WATCHPOINT);
     sdb_evalAndUpdateWP();
 }
 
@@ -171,15 +177,31 @@ static void execute(uint64_t n) {
             sim_state.haltPC = top->io_pc;
         }
         traceAndDiffTest();
+        if (sim_config.config_wave) {
+            ProfilerScope scope(PROF_WAVE);
+            // 执行过程中只有监视点会将状态置为 SIM_STOP
+            if (sim_state.state == SIM_STOP && sim_config.config_waveWatchpoint) {
+                wave_trigger("监视点");
+            }
+            wave_onExec(top->io_pc);
+        }
         if (sim_state.state != SIM_RUNNING) {
             break;
         }
         if (sim_config.config_device) {
+            ProfilerScope scope(PROF_DEVICE);
             device_update();
         }
+        if (sim_config.config_sampler) {
+            sampler_tick(execCount, top->io_pc);
+        }
+        profiler_tick(perf_counters.cycles, execCount);
+        perf_tick();
     }
 
-    if (sim_config.config_itrace) {
+    // 未开启 itrace 时只在仿真失败（含 a0 非零的 HIT BAD TRAP）时输出，便于定位出错的位置
+    if (sim_config.config_itrace || sim_state.state == SIM_ABORT ||
+        (sim_state.state == SIM_END && top->ioDPI_gprs_10 != 0)) {
         sim_state_itrace_iringbuf_dump();
     }
 }
@@ -211,15 +233,19 @@ void simExec(uint64_t n) {
             break;
         case SIM_END:
         case SIM_ABORT:
-            halt_ret = top->ioDPI_gprs_0;
-            if (sim_config.config_debugOutput)
-                std::cout << "仿真: " <<
-                    (sim_state.state == SIM_ABORT ?
-                        ANSI_FMT("ABORT", ANSI_FG_RED) :
-                        ANSI_FMT("HIT GOOD TRAP", ANSI_FG_GREEN)) <<
-                    " at pc = 0x" << std::setfill('0') <<
-                    std::setw(8) << std::hex << sim_state.haltPC << std::dec <<
-                    ", 结果: " << halt_ret << std::endl;
+            // 先写出程序尚未输出的内容，使其出现在仿真结果之前
+            device_serial_flush();
+            halt_ret = top->ioDPI_gprs_10;
+            // 无论是否开启调试输出都打印结果，供回归测试脚本解析
+            std::cout << "仿真: " <<
+                (sim_state.state == SIM_ABORT ?
+                    ANSI_FMT("ABORT", ANSI_FG_RED) :
+                    (halt_ret == 0 ?
+                        ANSI_FMT("HIT GOOD TRAP", ANSI_FG_GREEN) :
+                        ANSI_FMT("HIT BAD TRAP", ANSI_FG_RED))) <<
+                " at pc = 0x" << std::setfill('0') <<
+                std::setw(8) << std::hex << sim_state.haltPC << std::dec <<
+                ", 结果: " << halt_ret << std::endl;
     }
 }
 
@@ -237,29 +263,40 @@ bool simulate(bool sdbEnabled) {
 
     timer_initRand();
     disasm_init();
-    if (sim_config.config_itrace) {
-        sim_state_itrace_iringbuf_init();
-    }
-    if (sim_config.config_ftrace) {
+    // PC 采样分析同样需要函数符号表
+    if (sim_config.config_ftrace || sim_config.config_sampler) {
         if (!sim_state_ftrace_funcSyms_init()) {
             std::cerr << "函数符号表加载失败，请确保 ELF 文件路径正确！" << std::endl;
             return false;
         }
     }
     sim_state_ofstream_init();
+    profiler_init();
+    perf_init();
+    if (!initCacheSim()) {
+        std::cerr << "缓存模拟器配置有误: " << sim_config.config_cacheSimConfigs << std::endl;
+        return false;
+    }
+    if (!memmodel_init()) {
+        std::cerr << "主存时序模型配置有误: " << sim_config.config_memModelConfigs << std::endl;
+        return false;
+    }
 
+    dpi_init();
     top = new VProcessorCore(verContext);
 
-    if (sim_config.config_wave) {
-        tfp = new VerilatedFstC;
-        verContext->traceEverOn(true);
-        top->trace(tfp, 0);
-        tfp->open(sim_config.config_waveFilePath.c_str());
+    if (sim_config.config_wave && !wave_init()) {
+        return false;
     }
 
     if (sim_config.config_debugOutput)
         std::cout << "正在重置处理器..." << std::endl;
     simReset(1);
+    if (!sim_config.config_checkpointFilePath.empty()) {
+        if (sim_config.config_debugOutput)
+            std::cout << "正在从检查点恢复处理器状态..." << std::endl;
+        checkpoint_restore();
+    }
 
     if (sim_config.config_difftest) {
         if (sim_config.config_debugOutput)
@@ -269,8 +306,20 @@ bool simulate(bool sdbEnabled) {
             binFileSize,
             sim_config.config_difftestPort
         );
+        if (sim_config.config_fastForward > 0) {
+            // 由 REF 以解释执行的速度跑完启动阶段，再将其状态注入刚复位的处理器
+            ProcessorState state;
+            difftest_dut_fastForward(sim_config.config_fastForward, &state);
+            setProcessorState(state);
+            difftest_dut_syncCurrentProcessorState();
+        }
     }
 
+    // 复位及注入处理器状态的指令序列均不计入统计
+    perf_reset();
+    profiler_reset();
+    sampler_reset();
+
     if (sim_config.config_device) {
         if (sim_config.config_debugOutput)
             std::cout << "正在加载外部设备..." << std::endl;
@@ -282,24 +331,35 @@ bool simulate(bool sdbEnabled) {
     if (sdbEnabled) {
         sdb_init();
         sdb_mainLoop();
+    } else if (!sim_config.config_checkpointFilePath.empty()) {
+        checkpoint_run();
     } else {
         simExec(-1);
     }
 
     if (sim_config.config_debugOutput)
         std::cout << "仿真结束." << std::endl;
-    halt_ret = top->ioDPI_gprs_0;
-    delete top;
-
-    if (sim_config.config_itrace) {
-        sim_state_itrace_iringbuf_destroy();
+    if (sim_config.config_device) {
+        device_finalise();
+    }
+    profiler_report(perf_counters.cycles, execCount, true);
+    perf_finalise(top->io_pc);
+    reportCacheSim(perf_counters.instret);
+    memmodel_report(perf_counters.cycles, perf_counters.instret);
+    if (sim_config.config_sampler) {
+        sampler_dump();
+    }
+    halt_ret = top->ioDPI_gprs_10;
+    if (sim_config.config_wave) {
+        wave_finalise(sim_state.state == SIM_ABORT ||
+            (sim_state.state == SIM_END && halt_ret != 0));
     }
+    // 执行 final 块，--prof-pgo 编译的版本也在此时写出剖析数据
+    top->final();
+    delete top;
 
     sim_state_ofstream_finalise();
 
-    if (tfp) {
-        delete tfp;
-    }
-
-    return halt_ret == 0;
+    // ABORT 时 a0 可能恰好为 0，不能仅凭 halt_ret 判定成功
+    return sim_state.state != SIM_ABORT && halt_ret == 0;
 }
@@ -18,8 +18,23 @@ SimConfig sim_config = {
     .config_device = false,
     .config_wave = false,
     .config_debugOutput = false,
+    .config_profile = false,
+    .config_sampler = false,
+    .config_waveWatchpoint = false,
 
     .config_difftestPort = DEFAULT_DIFFTEST_PORT,
+    .config_cacheSimThreads = DEFAULT_CACHESIM_THREADS,
+    .config_profileInterval = DEFAULT_PROFILE_INTERVAL,
+    .config_perfCsvInterval = DEFAULT_PERF_CSV_INTERVAL,
+    .config_samplerInterval = DEFAULT_SAMPLER_INTERVAL,
+    .config_checkpointWarmup = DEFAULT_CHECKPOINT_WARMUP,
+    .config_checkpointMeasure = DEFAULT_CHECKPOINT_MEASURE,
+    .config_fastForward = 0,
+    .config_waveStartCycle = 0,
+    .config_waveEndCycle = 0,
+    .config_waveTriggerPC = 0,
+    .config_waveWindow = 0,
+    .config_waveFlight = 0,
 
     .config_itraceOutFilePath =
         std::move(std::string(DEFAULT_ITRACE_OUT_FILE_PATH)),
@@ -36,45 +51,38 @@ SimConfig sim_config = {
     .config_difftestSoFilePath =
         std::move(std::string(DEFAULT_DIFFTEST_SO_FILE_PATH)),
     .config_waveFilePath =
-        std::move(std::string(DEFAULT_WAVE_FILE_PATH))
+        std::move(std::string(DEFAULT_WAVE_FILE_PATH)),
+    .config_profileJsonFilePath = std::string(),
+    .config_perfCsvFilePath = std::string(),
+    .config_samplerOutFilePath =
+        std::move(std::string(DEFAULT_SAMPLER_OUT_FILE_PATH)),
+    .config_checkpointFilePath = std::string(),
+    .config_checkpointResultFilePath = std::string(),
+    .config_cacheSimConfigs = std::string(),
+    .config_memModelConfigs = std::string(),
+    .config_memModelStatsFilePath = std::string()
 };
 
 SimState sim_state = {
     .state = SIM_RUNNING,
     .haltPC = 0,
 
-    .itrace_iringbuf = nullptr
+    .itrace_iringbuf = {}
 };
 
 /**
- * @brief 初始化用于 itrace 的环形缓冲区。
- */
-void sim_state_itrace_iringbuf_init() {
-    sim_state.itrace_iringbuf = new RingBuffer(ITRACE_IRINGBUF_SIZE);
-}
-
-/**
- * @brief 释放用于 itrace 的环形缓冲区。
- */
-void sim_state_itrace_iringbuf_destroy() {
-    if (sim_state.itrace_iringbuf) {
-        delete sim_state.itrace_iringbuf;
-        sim_state.itrace_iringbuf = nullptr;
-    }
-}
-
-/**
- * @brief 输出用于 itrace 的环形缓冲区中的内容。
+ * @brief 反汇编并输出用于 itrace 的环形缓冲区中自上次输出以来的指令。
  */
 void sim_state_itrace_iringbuf_dump() {
-    try {
-        auto *iringbuf = sim_state.itrace_iringbuf;
-        std::string str = iringbuf->read(iringbuf->availableData());
-        std::cout << "itrace_iringbuf data:" << std::endl;
-        std::cout << str << std::endl;
-    } catch (const std::exception &e) {
-        std::cerr << "Failed to get iringbuf data: " << e.what() << std::endl;
+    auto &iringbuf = sim_state.itrace_iringbuf;
+    char buf[128];
+
+    std::cout << "itrace_iringbuf data:" << std::endl;
+    for (size_t i = 0; i < iringbuf.size(); i++) {
+        disasm_formatITrace(buf, sizeof(buf), iringbuf[i].pc, iringbuf[i].inst);
+        std::cout << (i == iringbuf.size() - 1 ? " --> " : "     ") << buf << std::endl;
     }
+    iringbuf.clear();
 }
 
 /**
@@ -225,39 +233,23 @@ void disasm_disassemble(
     cs_free_dl(insn, count);
 }
 
-// ----------- memory -----------
-
-word_t memoryHostRead(const void *addr, int len) {
-    switch (len) {
-        case 1:
-            return *((uint8_t *) addr);
-        case 2:
-            return *((uint16_t *) addr);
-        case 4:
-            return *((uint32_t *) addr);
-        case 8:
-            return *((uint64_t *) addr);
-        default:
-            panic();
-            return 0;
-    }
-}
+/**
+ * @brief 将一条指令格式化为 itrace 的一行（不含换行符）：地址、指令字节与反汇编结果。
+ *
+ * @param str 输出目的字符串缓冲区
+ * @param size 字符串缓冲区大小
+ * @param pc 指令地址
+ * @param inst 指令
+ */
+void disasm_formatITrace(char *str, int size, addr_t pc, word_t inst) {
+    char *p = str;
+    int ilen = 4; // TODO: 等实现 RV32C 指令集后需修改此处（RV32C单条指令长度为2）
+    uint8_t *code = (uint8_t *) &inst;
 
-void memoryHostWrite(void *addr, int len, word_t data) {
-    switch (len) {
-        case 1:
-            *((uint8_t *) addr) = data;
-            return;
-        case 2:
-            *((uint16_t *) addr) = data;
-            return;
-        case 4:
-            *((uint32_t *) addr) = data;
-            return;
-        case 8:
-            *((uint64_t *) addr) = data;
-            return;
-        default:
-            panic();
+    p += snprintf(p, size, FMT_WORD ":", pc);
+    for (int i = ilen - 1; i >= 0; i--) {
+        p += snprintf(p, 4, " %02x", code[i]);
     }
+    *p++ = ' ';
+    disasm_disassemble(p, str + size - p, pc, code, ilen);
 }
@@ -46,25 +46,28 @@ bool ftrace_tryRecord(
         }
 
         // 记录入栈信息：调用至目的函数
-        message = std::format("0x{:08x}: ", srcAddr);
-        for (i = 0; i < sim_state.ftrace_callStack.size(); i++) {
-            message += "  ";
+        // 仅维护调用栈（供采样器使用）时不写日志
+        if (sim_config.config_ftrace) {
+            message = std::format("0x{:08x}: ", srcAddr);
+            for (i = 0; i < sim_state.ftrace_callStack.size(); i++) {
+                message += "  ";
+            }
+            tmpStr = std::format(
+                "call to [{}@0x{:08x}]",
+                funcName, addr
+            );
+            message += tmpStr;
+            sim_state.ftrace_ofs << message << std::endl;
+            std::flush(sim_state.ftrace_ofs);
+            if (sim_config.config_debugOutput)
+                std::cout << "[sim] ftrace: " << message << std::endl;
         }
-        tmpStr = std::format(
-            "call to [{}@0x{:08x}]",
-            funcName, addr
-        );
-        message += tmpStr;
-        sim_state.ftrace_ofs << message << std::endl;
-        std::flush(sim_state.ftrace_ofs);
-        if (sim_config.config_debugOutput)
-            std::cout << "[sim] ftrace: " << message << std::endl;
 
         // 将该函数入栈
         CallStackInfo info;
         info.addr = addr;
         info.name = funcName;
-        sim_state.ftrace_callStack.push(std::move(info));
+        sim_state.ftrace_callStack.push_back(std::move(info));
 
         return true;
     }
@@ -82,34 +85,36 @@ bool ftrace_tryRecord(
         // 【注意】由于编译器/汇编器可能进行尾调用消除优化，出栈时要出到目标函数层级
         // （可能需要出不止一层栈）
         while (sim_state.ftrace_callStack.size() > 0) {
-            const auto &info = sim_state.ftrace_callStack.top();
+            const auto &info = sim_state.ftrace_callStack.back();
             if (info.name == destFuncName) {
                 break;
             }
             // 没到达目标层级，则继续出栈
-            sim_state.ftrace_callStack.pop();
+            sim_state.ftrace_callStack.pop_back();
         }
 
         // 记录信息：尾调用至另一个函数
-        message = std::format("0x{:08x}: ", srcAddr);
-        for (i = 0; i < sim_state.ftrace_callStack.size(); i++) {
-            message += "  ";
+        if (sim_config.config_ftrace) {
+            message = std::format("0x{:08x}: ", srcAddr);
+            for (i = 0; i < sim_state.ftrace_callStack.size(); i++) {
+                message += "  ";
+            }
+            tmpStr = std::format(
+                "tail from [{}@0x{:08x}] to [{}@0x{:08x}]",
+                funcName, srcAddr, destFuncName, addr
+            );
+            message += tmpStr;
+            sim_state.ftrace_ofs << message << std::endl;
+            std::flush(sim_state.ftrace_ofs);
+            if (sim_config.config_debugOutput)
+                std::cout << "[sim] ftrace: " << message << std::endl;
         }
-        tmpStr = std::format(
-            "tail from [{}@0x{:08x}] to [{}@0x{:08x}]",
-            funcName, srcAddr, destFuncName, addr
-        );
-        message += tmpStr;
-        sim_state.ftrace_ofs << message << std::endl;
-        std::flush(sim_state.ftrace_ofs);
-        if (sim_config.config_debugOutput)
-            std::cout << "[sim] ftrace: " << message << std::endl;
 
         // 再将目的函数入栈
         CallStackInfo info;
         info.addr = addr;
         info.name = destFuncName;
-        sim_state.ftrace_callStack.push(std::move(info));
+        sim_state.ftrace_callStack.push_back(std::move(info));
 
         return true;
     }
@@ -127,34 +132,36 @@ bool ftrace_tryRecord(
         // 【注意】由于编译器/汇编器可能进行尾调用消除优化，出栈时要出到目标函数层级
         // （可能需要出不止一层栈）
         if (destFuncName == "<unknown>") {
-            sim_state.ftrace_callStack.pop();
+            sim_state.ftrace_callStack.pop_back();
         } else {
             while (sim_state.ftrace_callStack.size() > 0) {
-                const auto &info = sim_state.ftrace_callStack.top();
+                const auto &info = sim_state.ftrace_callStack.back();
                 if (info.name == destFuncName) {
                     break;
                 }
                 // 没到达目标层级，则继续出栈
-                sim_state.ftrace_callStack.pop();
+                sim_state.ftrace_callStack.pop_back();
             }
         }
 
         // 记录出栈信息：从当前函数返回
         // 【注意】返回到的目的地址不是函数的起始地址，而是在函数体内部
         //        所以不方便记录目的函数信息，只能记录当前函数信息（从哪里返回）
-        message = std::format("0x{:08x}: ", srcAddr);
-        for (i = 0; i < sim_state.ftrace_callStack.size(); i++) {
-            message += "  ";
+        if (sim_config.config_ftrace) {
+            message = std::format("0x{:08x}: ", srcAddr);
+            for (i = 0; i < sim_state.ftrace_callStack.size(); i++) {
+                message += "  ";
+            }
+            tmpStr = std::format(
+                "ret from [{}@0x{:08x}] to [{}@0x{:08x}]",
+                funcName, srcAddr, destFuncName, addr
+            );
+            message += tmpStr;
+            sim_state.ftrace_ofs << message << std::endl;
+            std::flush(sim_state.ftrace_ofs);
+            if (sim_config.config_debugOutput)
+                std::cout << "[sim] ftrace: " << message << std::endl;
         }
-        tmpStr = std::format(
-            "ret from [{}@0x{:08x}] to [{}@0x{:08x}]",
-            funcName, srcAddr, destFuncName, addr
-        );
-        message += tmpStr;
-        sim_state.ftrace_ofs << message << std::endl;
-        std::flush(sim_state.ftrace_ofs);
-        if (sim_config.config_debugOutput)
-            std::cout << "[sim] ftrace: " << message << std::endl;
 
         return true;
     }
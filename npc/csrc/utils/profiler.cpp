@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <print>
+#include <string>
+#include <utils/profiler.hpp>
+
+ProfilerState profiler_state = {
+    .phase = PROF_HARNESS,
+    .lastTicks = 0,
+    .ticks = {}
+};
+
+uint64_t profiler_nextReportInsts = UINT64_MAX;
+
+// 须与 ProfilerPhase 的顺序一致
+static const char *phaseNames[NR_PROF_PHASE] = {
+    "harness",
+    "eval",
+    "wave",
+    "dpi",
+    "fetch",
+    "disasm",
+    "log",
+    "difftest",
+    "watchpoint",
+    "device"
+};
+
+static std::chrono::steady_clock::time_point startTime;
+static uint64_t startTicks = 0;
+
+// 上一次报告时的状态，用于计算阶段性的速率
+static double lastSeconds = 0;
+static uint64_t lastCycles = 0;
+static uint64_t lastInsts = 0;
+
+static std::ofstream jsonOfs;
+
+/**
+ * @brief 初始化性能分析器。需提前确保 sim_config 中相关配置信息已正确填入。
+ */
+void profiler_init() {
+    if (!sim_config.config_profile) {
+        return;
+    }
+
+    if (!sim_config.config_profileJsonFilePath.empty()) {
+        jsonOfs.open(sim_config.config_profileJsonFilePath);
+        if (!jsonOfs.is_open()) {
+            std::cerr << "[profiler] 无法打开 JSON 输出文件 " <<
+                sim_config.config_profileJsonFilePath << std::endl;
+        }
+    }
+
+    profiler_nextReportInsts = sim_config.config_profileInterval > 0 ?
+        sim_config.config_profileInterval : UINT64_MAX;
+
+    profiler_reset();
+}
+
+/**
+ * @brief 清零各阶段的耗时并重新开始计时。
+ */
+void profiler_reset() {
+    if (!sim_config.config_profile) {
+        return;
+    }
+
+    startTime = std::chrono::steady_clock::now();
+    startTicks = profiler_readTicks();
+    profiler_state.phase = PROF_HARNESS;
+    profiler_state.lastTicks = startTicks;
+    std::fill(std::begin(profiler_state.ticks), std::end(profiler_state.ticks), 0);
+    lastSeconds = 0;
+    lastCycles = 0;
+    lastInsts = 0;
+}
+
+/**
+ * @brief 输出性能分析报告，若指定了 JSON 输出路径则同时追加一行 JSON 记录。
+ *
+ * @param cycles 至今仿真的时钟周期数
+ * @param insts 至今执行的指令数
+ * @param final 是否为仿真结束时的最终报告
+ */
+void profiler_report(uint64_t cycles, uint64_t insts, bool final) {
+    if (!sim_config.config_profile) {
+        return;
+    }
+
+    // 先把当前阶段的耗时结算掉
+    profiler_enter(profiler_state.phase);
+
+    // TSC 的频率未知，用同一段时间内的墙钟时间换算
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - startTime).count();
+    uint64_t totalTicks = profiler_state.lastTicks - startTicks;
+    double secondsPerTick = totalTicks > 0 ? seconds / totalTicks : 0;
+
+    double interval = seconds - lastSeconds;
+    double cyclesPerSec = interval > 0 ? (cycles - lastCycles) / interval : 0;
+    double instsPerSec = interval > 0 ? (insts - lastInsts) / interval : 0;
+    if (final) {
+        // 最终报告给出整个运行期间的平均值
+        cyclesPerSec = seconds > 0 ? cycles / seconds : 0;
+        instsPerSec = seconds > 0 ? insts / seconds : 0;
+    }
+
+    std::println("[profiler] {}: {:.3f} s, {} cycles ({:.3f} M/s), {} insts ({:.3f} M/s)",
+        final ? "final" : "progress", seconds,
+        cycles, cyclesPerSec / 1e6, insts, instsPerSec / 1e6);
+    if (final) {
+        for (int i = 0; i < NR_PROF_PHASE; i++) {
+            double phaseSeconds = profiler_state.ticks[i] * secondsPerTick;
+            std::println("[profiler]   {:<12} {:>10.3f} s {:>6.2f}%",
+                phaseNames[i], phaseSeconds,
+                seconds > 0 ? phaseSeconds / seconds * 100 : 0);
+        }
+    }
+
+    if (jsonOfs.is_open()) {
+        std::string json = std::format(
+            "{{\"final\": {}, \"seconds\": {:.6f}, \"cycles\": {}, \"insts\": {}, "
+                "\"cyclesPerSec\": {:.1f}, \"instsPerSec\": {:.1f}, \"phases\": {{",
+            final, seconds, cycles, insts, cyclesPerSec, instsPerSec
+        );
+        for (int i = 0; i < NR_PROF_PHASE; i++) {
+            json += std::format("{}\"{}\": {:.6f}", i == 0 ? "" : ", ",
+                phaseNames[i], profiler_state.ticks[i] * secondsPerTick);
+        }
+        json += "}}";
+        jsonOfs << json << std::endl;
+    }
+
+    lastSeconds = seconds;
+    lastCycles = cycles;
+    lastInsts = insts;
+    if (!final && sim_config.config_profileInterval > 0) {
+        profiler_nextReportInsts = insts + sim_config.config_profileInterval;
+    }
+}
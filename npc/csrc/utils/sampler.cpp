@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <print>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <utils.hpp>
+#include <utils/sampler.hpp>
+
+#define SAMPLER_TABLE_ROWS 30
+
+/**
+ * @brief 以折叠后的调用栈（形如 "main;foo;bar"）为键的采样计数。
+ */
+static std::unordered_map<std::string, uint64_t> stackSamples;
+static uint64_t nrSamples = 0;
+
+/**
+ * @brief 每执行完一条指令后调用，每隔若干条指令对 PC 及其 ftrace 调用栈采样一次。
+ *
+ * @param insts 至今执行的指令数
+ * @param pc 下一条指令的 PC
+ */
+void sampler_tick(uint64_t insts, addr_t pc) {
+    if (insts % sim_config.config_samplerInterval != 0) {
+        return;
+    }
+
+    std::string stack, leaf;
+    for (const auto &info : sim_state.ftrace_callStack) {
+        if (!stack.empty()) {
+            stack += ';';
+        }
+        stack += info.name;
+    }
+    // 栈顶函数通常就是 PC 所在的函数，若不是（如未开启 ftrace）则补上
+    if (!ftrace_queryNameThroughSymbolTable(leaf, pc)) {
+        leaf = "<unknown>";
+    }
+    if (sim_state.ftrace_callStack.empty() || sim_state.ftrace_callStack.back().name != leaf) {
+        if (!stack.empty()) {
+            stack += ';';
+        }
+        stack += leaf;
+    }
+
+    stackSamples[stack]++;
+    nrSamples++;
+}
+
+/**
+ * @brief 丢弃已有的全部采样。
+ */
+void sampler_reset() {
+    stackSamples.clear();
+    nrSamples = 0;
+}
+
+/**
+ * @brief 输出折叠调用栈（可交给 flamegraph.pl 生成火焰图），
+ * 并将各函数的自身/总计指令数表格打印到标准输出。
+ */
+void sampler_dump() {
+    struct FuncSamples {
+        std::string name;
+        uint64_t self;
+        uint64_t total;
+    };
+    std::unordered_map<std::string, FuncSamples> funcs;
+    uint64_t interval = sim_config.config_samplerInterval;
+
+    if (nrSamples == 0) {
+        return;
+    }
+
+    std::ofstream ofs(sim_config.config_samplerOutFilePath);
+    if (!ofs.is_open()) {
+        std::cerr << "[sampler] 无法打开折叠调用栈输出文件 " <<
+            sim_config.config_samplerOutFilePath << std::endl;
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> stacks(stackSamples.begin(), stackSamples.end());
+    std::sort(stacks.begin(), stacks.end());
+    for (const auto &[stack, count] : stacks) {
+        if (ofs.is_open()) {
+            ofs << stack << " " << count * interval << "\n";
+        }
+
+        // 每个函数在同一调用栈中只计一次总计数，以正确处理递归
+        std::unordered_set<std::string> seen;
+        size_t start = 0;
+        while (true) {
+            size_t end = stack.find(';', start);
+            std::string name = stack.substr(start, end == std::string::npos ? end : end - start);
+            auto &f = funcs[name];
+            f.name = name;
+            if (seen.insert(name).second) {
+                f.total += count;
+            }
+            if (end == std::string::npos) {
+                f.self += count;
+                break;
+            }
+            start = end + 1;
+        }
+    }
+    if (ofs.is_open()) {
+        std::cout << "[sampler] 折叠调用栈已输出至 " << sim_config.config_samplerOutFilePath << std::endl;
+    }
+
+    std::vector<FuncSamples> table;
+    for (auto &[name, f] : funcs) {
+        table.push_back(std::move(f));
+    }
+    std::sort(table.begin(), table.end(), [](const FuncSamples &a, const FuncSamples &b) {
+        return a.self != b.self ? a.self > b.self : a.name < b.name;
+    });
+
+    std::println("[sampler] {} samples, one every {} instructions", nrSamples, interval);
+    std::println("{:<32} {:>14} {:>7} {:>14} {:>7}", "function", "self insts", "self%", "total insts", "total%");
+    for (size_t i = 0; i < table.size() && i < SAMPLER_TABLE_ROWS; i++) {
+        const auto &f = table[i];
+        std::println("{:<32} {:>14} {:>6.2f}% {:>14} {:>6.2f}%", f.name,
+            f.self * interval, f.self * 100.0 / nrSamples,
+            f.total * interval, f.total * 100.0 / nrSamples);
+    }
+}
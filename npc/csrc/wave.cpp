@@ -0,0 +1,267 @@
+#include <verilated_fst_c.h>
+#ifdef NPC_SAVABLE
+#include <verilated_save.h>
+#endif
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <print>
+#include <sim_top.hpp>
+#include <utils.hpp>
+#include <wave.hpp>
+
+/**
+ * @brief 一次 eval() 时处理器的全部输入，飞行记录模式据此重新仿真。
+ * 顶层增加输入端口时须同步修改此处。
+ */
+struct EvalInput {
+    uint8_t clock;
+    uint8_t reset;
+    uint32_t instData;
+    uint32_t readData;
+};
+
+/**
+ * @brief 飞行记录模式下的一个处理器快照，以及快照之后各次 eval() 的输入。
+ */
+struct FlightSnapshot {
+    bool valid;
+    uint64_t time;
+    std::string path;
+    std::vector<EvalInput> inputs;
+};
+
+static VerilatedFstC *tfp = nullptr;
+
+static bool recording = false;
+// 当前记录窗口结束的周期，为 0 表示不限
+static uint64_t windowEnd = 0;
+static bool rangeStarted = false;
+
+static bool flight = false;
+static FlightSnapshot snapshots[2];
+static int curSnapshot = 0;
+static uint64_t nextSnapshotCycle = 0;
+// 触发输出后，在此周期之前的再次触发不再重复输出，避免每次命中都重新仿真并覆盖同一个文件
+static uint64_t flightHoldCycle = 0;
+static std::string currentStatePath;
+
+static inline uint64_t currentCycle() {
+    return verContext->time() / 2;
+}
+
+static void startRecording(uint64_t end) {
+    if (!recording) {
+        std::println("[wave] 第 {} 个周期开始记录波形", currentCycle());
+    }
+    recording = true;
+    windowEnd = end;
+}
+
+#ifdef NPC_SAVABLE
+static bool saveModel(const std::string &path) {
+    VerilatedSave os;
+    os.open(path.c_str());
+    if (!os.isOpen()) {
+        std::cerr << "[wave] 无法写入处理器快照 " << path << std::endl;
+        return false;
+    }
+    os << *top;
+    os.close();
+    return true;
+}
+
+static bool restoreModel(const std::string &path) {
+    VerilatedRestore os;
+    os.open(path.c_str());
+    if (!os.isOpen()) {
+        std::cerr << "[wave] 无法读取处理器快照 " << path << std::endl;
+        return false;
+    }
+    os >> *top;
+    os.close();
+    return true;
+}
+
+static void takeSnapshot() {
+    curSnapshot ^= 1;
+    FlightSnapshot &snapshot = snapshots[curSnapshot];
+    snapshot.valid = saveModel(snapshot.path);
+    snapshot.time = verContext->time();
+    snapshot.inputs.clear();
+}
+
+static void replay(const std::vector<EvalInput> &inputs) {
+    for (const auto &in : inputs) {
+        top->clock = in.clock;
+        top->reset = in.reset;
+        top->io_instData = in.instData;
+        top->io_readData = in.readData;
+        top->eval();
+        // 重新仿真只为输出波形，主存等仿真环境的状态不能再被改动
+        dpi_discard();
+        verContext->timeInc(1);
+        tfp->dump(verContext->time());
+    }
+}
+#endif
+
+bool wave_init() {
+    tfp = new VerilatedFstC;
+    verContext->traceEverOn(true);
+    top->trace(tfp, 0);
+
+    flight = sim_config.config_waveFlight > 0;
+    if (flight) {
+#ifdef NPC_SAVABLE
+        for (int i = 0; i < 2; i++) {
+            snapshots[i].path = sim_config.config_waveFilePath + ".snap" + std::to_string(i);
+            snapshots[i].valid = false;
+            snapshots[i].inputs.reserve(sim_config.config_waveFlight * 2);
+        }
+        currentStatePath = sim_config.config_waveFilePath + ".snapcur";
+        std::println("[wave] 飞行记录模式，每 {} 个周期保存一次快照", sim_config.config_waveFlight);
+        return true;
+#else
+        std::cerr << "[wave] 当前构建未启用 --savable，不支持飞行记录模式!" << std::endl;
+        return false;
+#endif
+    }
+
+    tfp->open(sim_config.config_waveFilePath.c_str());
+    if (sim_config.config_waveStartCycle == 0 &&
+        sim_config.config_waveTriggerPC == 0 &&
+        !sim_config.config_waveWatchpoint) {
+        // 未指定开始记录的条件，从复位开始记录
+        recording = true;
+        windowEnd = sim_config.config_waveEndCycle;
+    }
+    return true;
+}
+
+void wave_onEval() {
+    if (flight) {
+        snapshots[curSnapshot].inputs.push_back({
+            top->clock, top->reset, top->io_instData, top->io_readData
+        });
+    }
+    verContext->timeInc(1);
+    if (recording) {
+        tfp->dump(verContext->time());
+    }
+}
+
+void wave_onExec(addr_t pc) {
+    uint64_t cycle = currentCycle();
+
+#ifdef NPC_SAVABLE
+    if (flight && cycle >= nextSnapshotCycle) {
+        takeSnapshot();
+        nextSnapshotCycle = cycle + sim_config.config_waveFlight;
+    }
+#endif
+    if (sim_config.config_waveStartCycle && !rangeStarted &&
+        cycle >= sim_config.config_waveStartCycle) {
+        rangeStarted = true;
+        startRecording(sim_config.config_waveEndCycle);
+    }
+    if (sim_config.config_waveTriggerPC && pc == sim_config.config_waveTriggerPC) {
+        wave_trigger("PC 匹配");
+    }
+    if (recording && windowEnd && cycle >= windowEnd) {
+        wave_stop();
+    }
+}
+
+void wave_trigger(const char *reason) {
+    if (flight) {
+        uint64_t cycle = currentCycle();
+        if (cycle < flightHoldCycle) {
+            return;
+        }
+        std::println("[wave] 波形记录由 {} 触发", reason);
+        if (wave_flightDump()) {
+            flightHoldCycle = cycle + sim_config.config_waveFlight;
+            std::println("[wave] 第 {} 个周期之前的触发将被忽略", flightHoldCycle);
+        }
+        return;
+    }
+    std::println("[wave] 波形记录由 {} 触发", reason);
+    startRecording(sim_config.config_waveWindow ?
+        currentCycle() + sim_config.config_waveWindow : 0);
+}
+
+void wave_stop() {
+    if (recording) {
+        std::println("[wave] 第 {} 个周期停止记录波形", currentCycle());
+        tfp->flush();
+    }
+    recording = false;
+    windowEnd = 0;
+}
+
+bool wave_flightDump() {
+#ifdef NPC_SAVABLE
+    FlightSnapshot &cur = snapshots[curSnapshot];
+    FlightSnapshot &prev = snapshots[curSnapshot ^ 1];
+    uint64_t now = verContext->time();
+
+    if (!flight) {
+        std::println("[wave] 未开启飞行记录模式 (NPC_CONFIG_WAVE_FLIGHT)");
+        return false;
+    }
+    if (!cur.valid) {
+        std::println("[wave] 尚未保存任何快照，无法输出波形");
+        return false;
+    }
+    if (!saveModel(currentStatePath)) {
+        return false;
+    }
+
+    // 从较早的快照开始，保证窗口至少覆盖 NPC_CONFIG_WAVE_FLIGHT 个周期
+    FlightSnapshot &from = prev.valid ? prev : cur;
+    if (!restoreModel(from.path)) {
+        return false;
+    }
+    tfp->open(sim_config.config_waveFilePath.c_str());
+    verContext->time(from.time);
+    replay(from.inputs);
+    if (&from != &cur) {
+        replay(cur.inputs);
+    }
+    tfp->close();
+
+    restoreModel(currentStatePath);
+    verContext->time(now);
+    std::println("[wave] 已将第 {} 至 {} 个周期的波形写入 {}",
+        from.time / 2, now / 2, sim_config.config_waveFilePath);
+    return true;
+#else
+    std::println("[wave] 当前构建未启用 --savable，不支持飞行记录模式!");
+    return false;
+#endif
+}
+
+void wave_finalise(bool failed) {
+    if (flight) {
+        if (failed) {
+            wave_flightDump();
+        }
+        for (const auto &snapshot : snapshots) {
+            if (!snapshot.path.empty()) {
+                std::remove(snapshot.path.c_str());
+            }
+        }
+        if (!currentStatePath.empty()) {
+            std::remove(currentStatePath.c_str());
+        }
+    }
+    if (tfp) {
+        if (tfp->isOpen()) {
+            tfp->close();
+        }
+        delete tfp;
+        tfp = nullptr;
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef __CHECKPOINT_HPP__
+#define __CHECKPOINT_HPP__ 1
+
+#include <cstdint>
+#include <common.hpp>
+
+#define CHECKPOINT_MAGIC "NEMUCKPT"
+#define CHECKPOINT_PAGE_SIZE 4096
+
+/**
+ * @brief NEMU 输出的检查点文件头，与 NEMU 中的 SimpointCkptHeader 一致。
+ * 文件头之后依次为处理器状态（与 ProcessorState 布局相同）以及
+ * nr_pages 个 { uint64_t paddr; uint8_t data[CHECKPOINT_PAGE_SIZE]; } 内存页。
+ */
+struct CheckpointHeader {
+    char magic[8];
+    uint64_t interval;
+    uint64_t instCount;
+    uint64_t stateSize;
+    uint64_t nrPages;
+};
+
+/**
+ * @brief 从检查点文件加载内容到主存中，并暂存其中的处理器状态。
+ *
+ * @param filename 文件名
+ * @param imgSize 镜像大小缓冲区，用以保存主存中被加载部分的大小
+ * @return true 成功
+ * @return false 失败
+ */
+bool checkpoint_load(const char *filename, size_t *imgSize);
+
+/**
+ * @brief 处理器复位后调用，将检查点中的处理器状态注入处理器。
+ */
+void checkpoint_restore();
+
+/**
+ * @brief 依次仿真预热窗口与测量窗口，并输出测量窗口内的 IPC。
+ */
+void checkpoint_run();
+
+#endif /* __CHECKPOINT_HPP__ */
@@ -12,4 +12,9 @@ void device_update();
  */
 void device_init();
 
+/**
+ * @brief 仿真结束时调用，写出外部设备中尚未输出的内容。
+ */
+void device_finalise();
+
 #endif /* __DEVICE_HPP__ */
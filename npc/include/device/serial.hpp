@@ -3,4 +3,9 @@
 
 void device_serial_init();
 
+/**
+ * @brief 将串口输出缓冲区中的内容写到主机的标准错误输出。
+ */
+void device_serial_flush();
+
 #endif /* __DEVICE__SERIAL_HPP__ */
@@ -3,6 +3,7 @@
 
 #include <common.hpp>
 #include <difftest-def.hpp>
+#include <processor.hpp>
 
 /**
  * @brief DiffTest dut: 跳过在 DUT 上能执行但在 REF 上不能执行的一条指令。
@@ -54,6 +55,15 @@ void difftest_dut_init(const char *refSoFile, size_t imgSize, int port);
  */
 void difftest_dut_step(addr_t pc, addr_t npc);
 
+/**
+ * @brief DiffTest dut: 让 REF 先行执行若干条指令，再将 REF 的主存内容
+ * 拷贝回 DUT 的主存，并取出 REF 的处理器状态，以便 DUT 从该处继续执行。
+ * 
+ * @param n 需要在 REF 上执行的指令数量。
+ * @param state 处理器状态缓冲区，用以保存 REF 执行完毕后的处理器状态。
+ */
+void difftest_dut_fastForward(uint64_t n, ProcessorState *state);
+
 /**
  * @brief DiffTest dut: 向 REF 传送当前处理器状态以保持状态同步。
  */
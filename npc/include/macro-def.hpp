@@ -16,6 +16,7 @@
 #define RISCV_CSR_NUM 4096
 
 #define SERIAL_MMIO_ADDR    0xa00003f8
+#define SERIAL_TX_MMIO_ADDR 0xa0000800
 #define RTC_MMIO_ADDR       0xa0000048
 #define VGA_CTL_MMIO_ADDR   0xa0000100
 #define VGA_FB_MMIO_ADDR    0xa1000000
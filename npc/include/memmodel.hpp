@@ -0,0 +1,52 @@
+#ifndef __MEMMODEL_HPP__
+#define __MEMMODEL_HPP__ 1
+
+#include <cstdint>
+#include <common.hpp>
+
+/*
+ * 主存时序模型。处理器与仿真环境之间目前没有握手信号，访存在 DPI 回调中立即完成，
+ * 因此这里并不真正阻塞处理器，而是在原有主存后端之前插入一层后端，按区域配置
+ * 计算每次访问的完成时间，把读与取指超出一个周期的部分累计为阻塞周期。
+ * 写入视为 posted write，不阻塞处理器，但同样占用存储体与未完成请求的名额。
+ *
+ * 配置由 NPC_CONFIG_MEMMODEL 给出，各区域以分号分隔，格式为
+ *     <类型>:<起始地址>-<结束地址>[:<键>=<值>,...]
+ * 类型为 sram、dram 或 mmio，结束地址不包含在区域内。可用的键：
+ *     lat        固定延迟（周期）
+ *     jitter     在固定延迟之上附加 [0, jitter] 内的随机延迟
+ *     banks      存储体个数，须为 2 的幂
+ *     interleave 相邻存储体的地址间隔（字节），须为 2 的幂，dram 缺省为行大小
+ *     bankbusy   存储体每次访问后的占用周期，缺省为该次访问的延迟
+ *     row        行大小（字节），仅 dram
+ *     rowhit     行命中延迟，仅 dram
+ *     rowmiss    行缺失延迟（预充电加激活），仅 dram
+ *     out        最多同时未完成的请求数，0 表示不限
+ * 例如：
+ *     dram:0x80000000-0x88000000:rowhit=14,rowmiss=40,banks=8;mmio:0xa0000000-0xb0000000:lat=10,jitter=5
+ * 未落在任何区域内的访问不计延迟。
+ */
+
+/**
+ * @brief 按 sim_config 中的配置创建主存时序模型，并接在当前主存后端之前，未配置时不做任何事。
+ *
+ * @return true 成功
+ * @return false 配置有误
+ */
+bool memmodel_init();
+
+/**
+ * @brief 时序模型累计的阻塞周期数。
+ */
+uint64_t memmodel_stallCycles();
+
+/**
+ * @brief 输出各区域的统计结果，以及计入阻塞周期后的周期数与 IPC，
+ * 并按 NPC_CONFIG_MEMMODEL_STATS_FILE_PATH 写出 JSON 文件；随后卸下时序模型。
+ *
+ * @param cycles 处理器实际运行的周期数
+ * @param insts 期间执行的指令数
+ */
+void memmodel_report(uint64_t cycles, uint64_t insts);
+
+#endif /* __MEMMODEL_HPP__ */
@@ -36,6 +36,69 @@ static bool isPhysMemoryAddr(addr_t addr) {
     return addr - MEMORY_OFFSET < PHYS_MEMORY_SIZE;
 }
 
+/**
+ * @brief 主存后端接口。readMemory/writeMemory/fetchMemory 经由当前后端访问主存，
+ * 以便日后接入其他的主存模型。
+ */
+class MemoryBackend {
+public:
+    virtual ~MemoryBackend() = default;
+
+    /**
+     * @brief 后端名称，用于输出提示。
+     */
+    virtual const char *name() const = 0;
+
+    /**
+     * @brief 读取主存或设备。
+     *
+     * @param addr 主存地址（包含了内存地址偏移的）
+     * @param len 读取长度（单位为字节）
+     * @return word_t 读取到的内容
+     */
+    virtual word_t read(addr_t addr, int len) = 0;
+
+    /**
+     * @brief 写入主存或设备。
+     *
+     * @param addr 主存地址（包含了内存地址偏移的）
+     * @param len 写入长度（单位为字节）
+     * @param data 将要写入的内容
+     */
+    virtual void write(addr_t addr, int len, word_t data) = 0;
+
+    /**
+     * @brief 取指令，取指缓存未命中且该页不能直接读取时调用，缺省与 read 相同。
+     *
+     * @param addr 主存地址（包含了内存地址偏移的）
+     * @return word_t 读取到的指令
+     */
+    virtual word_t fetch(addr_t addr) {
+        return read(addr, sizeof(word_t));
+    }
+
+    /**
+     * @brief 返回地址所在页在主机上的起始地址，供取指缓存直接读取。
+     * 该页不能直接读取（如 MMIO）时返回 nullptr，取指将经由 read 完成。
+     *
+     * @param addr 主存地址（包含了内存地址偏移的）
+     * @return const uint8_t* 页在主机上的起始地址
+     */
+    virtual const uint8_t *hostPage(addr_t addr) = 0;
+};
+
+/**
+ * @brief 更换主存后端，并清空取指缓存。传入 nullptr 时恢复为默认的直接映射后端。
+ *
+ * @param backend 新的主存后端，由调用者负责其生命周期
+ */
+void setMemoryBackend(MemoryBackend *backend);
+
+/**
+ * @brief 返回当前的主存后端。
+ */
+MemoryBackend *getMemoryBackend();
+
 /**
  * @brief 从给定二进制文件（bin）加载内容到主存中。
  * 
@@ -46,6 +109,29 @@ static bool isPhysMemoryAddr(addr_t addr) {
  */
 bool initMemory(const char *filename, size_t *fileSize);
 
+/**
+ * @brief 按 sim_config 中的配置创建缓存模拟器，未配置时不做任何事。
+ *
+ * @return true 成功
+ * @return false 缓存配置有误
+ */
+bool initCacheSim();
+
+/**
+ * @brief 输出缓存模拟器的统计结果。
+ *
+ * @param insts 期间执行的指令数，用于计算 MPKI
+ */
+void reportCacheSim(uint64_t insts);
+
+/**
+ * @brief 从主存中取指令，与 readMemory 的区别在于缓存模拟器将其计入指令缓存。
+ *
+ * @param addr 主存地址（包含了内存地址偏移的）
+ * @return word_t 读取到的指令
+ */
+word_t fetchMemory(addr_t addr);
+
 /**
  * @brief 从主存中读取内容。
  * 
@@ -55,6 +141,16 @@ bool initMemory(const char *filename, size_t *fileSize);
  */
 word_t readMemory(addr_t addr, int len);
 
+/**
+ * @brief 供调试器（SDB 的 x 命令与表达式求值）读取主存或设备。
+ * 不经过主存时序模型等后端，也不计入缓存模拟器，以免调试操作影响统计结果。
+ *
+ * @param addr 主存地址（包含了内存地址偏移的）
+ * @param len 读取长度（单位为字节）
+ * @return word_t 读取到的内容
+ */
+word_t debugReadMemory(addr_t addr, int len);
+
 /**
  * @brief 向主存中写入内容。
  * 
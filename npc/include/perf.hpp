@@ -0,0 +1,123 @@
+#ifndef __PERF_HPP__
+#define __PERF_HPP__ 1
+
+#include <cstdint>
+#include <common.hpp>
+#include <utils/Stage.hpp>
+
+/**
+ * @brief 按类别统计的已提交指令。
+ */
+enum PerfInstClass {
+    PERF_INST_ALU,
+    PERF_INST_LOAD,
+    PERF_INST_STORE,
+    PERF_INST_BRANCH_TAKEN,
+    PERF_INST_BRANCH_NOT_TAKEN,
+    PERF_INST_JUMP,
+    PERF_INST_CSR,
+    PERF_INST_ECALL,
+    PERF_INST_OTHER,
+    NR_PERF_INST_CLASS
+};
+
+/**
+ * @brief 处理器性能计数器。
+ */
+struct PerfCounters {
+    /**
+     * @brief 时钟周期数。
+     */
+    uint64_t cycles;
+    /**
+     * @brief 处理器处于各阶段的时钟周期数，以 Stage 为索引。
+     */
+    uint64_t stageCycles[1 << STAGE_LEN];
+    /**
+     * @brief 访存阻塞周期数，即每条指令在 MA 阶段停留超过一个周期的部分。
+     */
+    uint64_t memStallCycles;
+    /**
+     * @brief 已提交的指令数。
+     */
+    uint64_t instret;
+    /**
+     * @brief 各类别已提交的指令数，以 PerfInstClass 为索引。
+     */
+    uint64_t instClass[NR_PERF_INST_CLASS];
+};
+
+extern PerfCounters perf_counters;
+
+/**
+ * @brief 上一个时钟周期处理器所处的阶段。
+ */
+extern uint8_t perf_lastStage;
+
+/**
+ * @brief 每个时钟周期调用一次，统计该周期处理器所处的阶段。
+ *
+ * @param stage 该周期处理器所处的阶段
+ */
+static inline void perf_onCycle(uint8_t stage) {
+    stage &= (1 << STAGE_LEN) - 1;
+    perf_counters.cycles++;
+    perf_counters.stageCycles[stage]++;
+    if (stage == STAGE_MA && perf_lastStage == STAGE_MA) {
+        perf_counters.memStallCycles++;
+    }
+    perf_lastStage = stage;
+}
+
+/**
+ * @brief 每条指令取指时调用。条件分支是否跳转要等到下一条指令取指时才能确定。
+ *
+ * @param pc 本次取指的 PC
+ */
+void perf_onFetch(addr_t pc);
+
+/**
+ * @brief 每条指令提交后调用，按类别统计该指令。
+ *
+ * @param pc 该指令的 PC
+ * @param inst 该指令
+ */
+void perf_onRetire(addr_t pc, word_t inst);
+
+/**
+ * @brief 初始化性能计数器的 CSV 输出。需提前确保 sim_config 中相关配置信息已正确填入。
+ */
+void perf_init();
+
+/**
+ * @brief 每执行完一条指令后调用，达到输出间隔时向 CSV 文件追加一行。
+ */
+void perf_tick();
+
+/**
+ * @brief 将所有性能计数器及 IPC、CPI 打印到标准输出。
+ */
+void perf_display();
+
+/**
+ * @brief 清零所有性能计数器，用于排除复位期间的时钟周期。
+ */
+void perf_reset();
+
+/**
+ * @brief 确定最后一条条件分支是否跳转，然后关闭性能计数器的 CSV 输出，并追加最后一行。
+ *
+ * @param pc 仿真结束时处理器的 PC，即下一条指令取指的 PC
+ */
+void perf_finalise(addr_t pc);
+
+/**
+ * @brief 以 CSR 的形式读取性能计数器，如 mcycle、minstret、mhpmcounter3 等。
+ *
+ * @param name CSR 名称
+ * @param success 操作是否成功
+ * @return word_t 计数器的值；若不存在该 CSR 则返回0
+ */
+word_t perf_csrStr2Val(const char *name, bool *success);
+
+#endif /* __PERF_HPP__ */
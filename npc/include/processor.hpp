@@ -34,4 +34,11 @@ extern "C" struct ProcessorState {
  */
 ProcessorState getProcessorState();
 
+/**
+ * @brief 将仿真环境的处理器设置为给定状态。处理器刚复位时调用。
+ * 
+ * @param state 处理器状态
+ */
+void setProcessorState(const ProcessorState &state);
+
 #endif /* __PROCESSOR_HPP__ */
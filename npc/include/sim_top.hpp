@@ -25,6 +25,21 @@ extern bool sim_halt;
 
 #define DEFAULT_BIN_PATH "build/program.bin"
 
+/**
+ * @brief 按配置建立 DPI 事件的处理函数表，须在仿真开始前调用。
+ */
+void dpi_init();
+
+/**
+ * @brief 处理 eval() 期间发生的 DPI 事件，须在 eval() 返回后由主线程调用。
+ */
+void dpi_dispatch();
+
+/**
+ * @brief 丢弃 eval() 期间发生的 DPI 事件，用于只为输出波形而重新仿真的场合。
+ */
+void dpi_discard();
+
 /**
  * @brief 执行一步仿真，执行一个时钟周期。
  */
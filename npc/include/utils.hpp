@@ -2,11 +2,11 @@
 #define __UTILS_HPP__ 1
 
 #include <stdint.h>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
-#include <stack>
 #include <utils/RingBuffer.hpp>
 #include <utils/Symbol.hpp>
 #include <utils/CallStackInfo.hpp>
@@ -17,7 +17,8 @@ enum SimStateEnum { SIM_RUNNING, SIM_STOP, SIM_END, SIM_ABORT, SIM_QUIT };
 
 #define CALL_STACK_MAX_DEPTH 1024
 
-#define ITRACE_IRINGBUF_SIZE 1024
+// itrace 环形缓冲区保留的指令条数，须为 2 的幂
+#define ITRACE_IRINGBUF_SIZE 32
 
 #define DEFAULT_DIFFTEST_PORT 12345
 #define DEFAULT_ITRACE_OUT_FILE_PATH "build/itrace.log"
@@ -28,6 +29,14 @@ enum SimStateEnum { SIM_RUNNING, SIM_STOP, SIM_END, SIM_ABORT, SIM_QUIT };
 #define DEFAULT_ELF_FILE_PATH "build/program.elf"
 #define DEFAULT_DIFFTEST_SO_FILE_PATH "build/riscv32-nemu-interpreter-so"
 #define DEFAULT_WAVE_FILE_PATH "build/sim.fst"
+#define DEFAULT_SAMPLER_OUT_FILE_PATH "build/sampler.folded"
+#define DEFAULT_PROFILE_INTERVAL 10000000
+#define DEFAULT_PERF_CSV_INTERVAL 1000000
+#define DEFAULT_SAMPLER_INTERVAL 100
+#define DEFAULT_CHECKPOINT_WARMUP 1000000
+#define DEFAULT_CHECKPOINT_MEASURE 10000000
+#define DEFAULT_CACHESIM_THREADS 4
+#define DEFAULT_WAVE_FLIGHT 100000
 
 struct SimConfig {
     bool config_itrace;
@@ -39,8 +48,23 @@ struct SimConfig {
     bool config_device;
     bool config_wave;
     bool config_debugOutput;
+    bool config_profile;
+    bool config_sampler;
+    bool config_waveWatchpoint;
 
     int config_difftestPort;
+    int config_cacheSimThreads;
+    uint64_t config_profileInterval;
+    uint64_t config_perfCsvInterval;
+    uint64_t config_samplerInterval;
+    uint64_t config_checkpointWarmup;
+    uint64_t config_checkpointMeasure;
+    uint64_t config_fastForward;
+    uint64_t config_waveStartCycle;
+    uint64_t config_waveEndCycle;
+    uint64_t config_waveTriggerPC;
+    uint64_t config_waveWindow;
+    uint64_t config_waveFlight;
 
     std::string config_itraceOutFilePath;
     std::string config_mtraceOutFilePath;
@@ -50,15 +74,31 @@ struct SimConfig {
     std::string config_elfFilePath;
     std::string config_difftestSoFilePath;
     std::string config_waveFilePath;
+    std::string config_profileJsonFilePath;
+    std::string config_perfCsvFilePath;
+    std::string config_samplerOutFilePath;
+    std::string config_checkpointFilePath;
+    std::string config_checkpointResultFilePath;
+    std::string config_cacheSimConfigs;
+    std::string config_memModelConfigs;
+    std::string config_memModelStatsFilePath;
+};
+
+/**
+ * @brief itrace 环形缓冲区中的一条记录，输出时才反汇编。
+ */
+struct ITraceRecord {
+    addr_t pc;
+    word_t inst;
 };
 
 struct SimState {
     SimStateEnum state;
     addr_t haltPC;
 
-    RingBuffer *itrace_iringbuf;
+    RingBuffer<ITraceRecord, ITRACE_IRINGBUF_SIZE> itrace_iringbuf;
     std::vector<Symbol> ftrace_funcSyms;
-    std::stack<CallStackInfo> ftrace_callStack;
+    std::vector<CallStackInfo> ftrace_callStack; // 以 vector 作栈，栈底在前，便于采样时遍历
 
     std::ofstream itrace_ofs;
     std::ofstream mtrace_ofs;
@@ -72,17 +112,7 @@ extern SimConfig sim_config;
 extern SimState sim_state;
 
 /**
- * @brief 初始化用于 itrace 的环形缓冲区。
- */
-void sim_state_itrace_iringbuf_init();
-
-/**
- * @brief 释放用于 itrace 的环形缓冲区。
- */
-void sim_state_itrace_iringbuf_destroy();
-
-/**
- * @brief 输出用于 itrace 的环形缓冲区中的内容。
+ * @brief 反汇编并输出用于 itrace 的环形缓冲区中自上次输出以来的指令。
  */
 void sim_state_itrace_iringbuf_dump();
 
@@ -150,6 +180,16 @@ void disasm_init();
  */
 void disasm_disassemble(char *str, int size, uint64_t pc, uint8_t *code, int nbyte);
 
+/**
+ * @brief 将一条指令格式化为 itrace 的一行（不含换行符）：地址、指令字节与反汇编结果。
+ *
+ * @param str 输出目的字符串缓冲区
+ * @param size 字符串缓冲区大小
+ * @param pc 指令地址
+ * @param inst 指令
+ */
+void disasm_formatITrace(char *str, int size, addr_t pc, word_t inst);
+
 // ----------- ftrace -----------
 
 /**
@@ -175,7 +215,11 @@ bool ftrace_tryRecord(CallType type, addr_t srcAddr, addr_t addr);
 
 // ----------- panic -----------
 
+void device_serial_flush();
+
+// abort() 不会执行 atexit 注册的函数，须先写出串口中尚未输出的内容
 #define panic(...) do {                  \
+	device_serial_flush();               \
 	fprintf(stderr, "panic: %s:%u: %s:", \
 		__FILE__, __LINE__, __func__);   \
 	fprintf(stderr, " " __VA_ARGS__);	 \
@@ -192,9 +236,66 @@ bool ftrace_tryRecord(CallType type, addr_t srcAddr, addr_t addr);
 
 // ----------- memory -----------
 
-word_t memoryHostRead(const void *addr, int len);
+/**
+ * @brief 从主机内存中读取内容。主机与处理器均为小端序，可直接按整数读取；
+ * 以 memcpy 访问，不要求地址对齐。位于访存的热路径上，因此定义为内联函数。
+ *
+ * @param addr 主机地址
+ * @param len 读取的字节数
+ * @return word_t 读取到的内容
+ */
+static inline word_t memoryHostRead(const void *addr, int len) {
+    uint64_t d;
+    uint32_t w;
+    uint16_t h;
+
+    switch (len) {
+        case 1:
+            return *((const uint8_t *) addr);
+        case 2:
+            std::memcpy(&h, addr, 2);
+            return h;
+        case 4:
+            std::memcpy(&w, addr, 4);
+            return w;
+        case 8:
+            std::memcpy(&d, addr, 8);
+            return d;
+        default:
+            panic("Invalid memory read length %d", len);
+            return 0;
+    }
+}
 
-void memoryHostWrite(void *addr, int len, word_t data);
+/**
+ * @brief 向主机内存中写入内容，不要求地址对齐。
+ *
+ * @param addr 主机地址
+ * @param len 写入的字节数
+ * @param data 写入的内容
+ */
+static inline void memoryHostWrite(void *addr, int len, word_t data) {
+    uint64_t d = data;
+    uint32_t w = data;
+    uint16_t h = data;
+
+    switch (len) {
+        case 1:
+            *((uint8_t *) addr) = data;
+            return;
+        case 2:
+            std::memcpy(addr, &h, 2);
+            return;
+        case 4:
+            std::memcpy(addr, &w, 4);
+            return;
+        case 8:
+            std::memcpy(addr, &d, 8);
+            return;
+        default:
+            panic("Invalid memory write length %d", len);
+    }
+}
 
 // ----------- util macros -----------
 
@@ -1,81 +1,71 @@
 #ifndef __UTILS__RINGBUFFER_HPP__
 #define __UTILS__RINGBUFFER_HPP__ 1
 
-#include <vector>
-#include <stdexcept>
-#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
 
 /**
- * @brief 环形缓冲区。
+ * @brief 定长环形缓冲区，写满后覆盖最旧的元素。
+ * 写入只有一次存储与一次计数器自增，适合在每条指令上常开。
+ *
+ * @tparam T 元素类型
+ * @tparam N 容量，须为 2 的幂
  */
+template <typename T, size_t N>
 class RingBuffer {
-public:
-    /**
-     * @brief 构造一个新的环形缓冲区。
-     * 
-     * @param capacity 该环形缓冲区的容量
-     */
-    explicit RingBuffer(size_t capacity);
+    static_assert(N > 0 && (N & (N - 1)) == 0, "RingBuffer capacity must be a power of 2");
 
+public:
     /**
-     * @brief 获取环形缓冲区中已经存在的数据大小。
-     * 
-     * @return size_t 环形缓冲区中已经存在的数据大小
+     * @brief 向环形缓冲区写入一个元素。
+     *
+     * @param item 要写入的元素
      */
-    size_t availableData() const;
+    void push(const T &item) {
+        m_buffer[m_count++ & (N - 1)] = item;
+    }
 
     /**
-     * @brief 获取环形缓冲区中可用空间的大小。
-     * 
-     * @return size_t 环形缓冲区中可用空间的大小
+     * @brief 获取自上次 clear() 以来仍保留在缓冲区中的元素个数。
+     *
+     * @return size_t 元素个数
      */
-    size_t availableSpace() const;
+    size_t size() const {
+        return std::min<uint64_t>(m_count - m_read, N);
+    }
 
     /**
      * @brief 判断环形缓冲区是否为空。
-     * 
+     *
      * @return true 环形缓冲区为空
      * @return false 环形缓冲区不为空
      */
-    bool empty() const;
-
-    /**
-     * @brief 判断环形缓冲区是否已满。
-     * 
-     * @return true 环形缓冲区已满
-     * @return false 环形缓冲区未满
-     */
-    bool full() const;
-
-    /**
-     * @brief 向环形缓冲区写入数据。
-     * 
-     * @param data 要写入的数据
-     * @param overwrite 若丢弃量大于可用空间，是否覆盖旧数据
-     */
-    void write(const std::string &data, bool overwrite = false);
+    bool empty() const {
+        return size() == 0;
+    }
 
     /**
-     * @brief 从环形缓冲区中读取数据。
-     * 
-     * @param amount 要读取的数据量
-     * @return std::string 读取的数据
+     * @brief 按写入顺序访问元素，0 为最旧的元素。
+     *
+     * @param i 下标，须小于 size()
+     * @return const T& 元素
      */
-    std::string read(size_t amount);
+    const T &operator[](size_t i) const {
+        return m_buffer[(m_count - size() + i) & (N - 1)];
+    }
 
     /**
-     * @brief 从环形缓冲区中丢弃数据。
-     * 
-     * @param amount 要丢弃的数据量
-     * @param overwrite 若丢弃量大于可用空间，是否覆盖旧数据
+     * @brief 将当前所有元素标记为已读取。
      */
-    void discard(size_t amount, bool overwrite = false);
+    void clear() {
+        m_read = m_count;
+    }
 
 private:
-    std::vector<char> m_buffer;
-    size_t m_capacity;
-    size_t m_start;
-    size_t m_end;
+    T m_buffer[N] = {};
+    uint64_t m_count = 0;
+    uint64_t m_read = 0;
 };
 
 #endif /* __UTILS__RINGBUFFER_HPP__ */
@@ -0,0 +1,122 @@
+#ifndef __UTILS__PROFILER_HPP__
+#define __UTILS__PROFILER_HPP__ 1
+
+#include <cstdint>
+#include <ctime>
+#include <utils.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief 仿真框架中被计时的各个阶段。
+ * 任意时刻仿真框架恰好处于其中一个阶段，各阶段的时间互不重叠。
+ */
+enum ProfilerPhase {
+    PROF_HARNESS,    // 未归入以下阶段的其余部分（含调试信息输出）
+    PROF_EVAL,       // Verilator eval()（不含 DPI 回调）
+    PROF_WAVE,       // FST 波形输出
+    PROF_DPI,        // DPI 回调
+    PROF_FETCH,      // 取指
+    PROF_DISASM,     // capstone 反汇编
+    PROF_LOG,        // itrace 日志输出
+    PROF_DIFFTEST,   // DiffTest
+    PROF_WATCHPOINT, // 监视点求值
+    PROF_DEVICE,     // 外部设备更新
+    NR_PROF_PHASE
+};
+
+struct ProfilerState {
+    ProfilerPhase phase;
+    uint64_t lastTicks;
+    uint64_t ticks[NR_PROF_PHASE];
+};
+
+extern ProfilerState profiler_state;
+
+/**
+ * @brief 下一次输出阶段性报告时的指令数。
+ */
+extern uint64_t profiler_nextReportInsts;
+
+/**
+ * @brief 读取计时器。x86 上直接读取 TSC，其余平台退化为 clock_gettime。
+ *
+ * @return uint64_t 计时器读数（单位不定，报告时再换算为秒）
+ */
+static inline uint64_t profiler_readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ull + now.tv_nsec;
+#endif
+}
+
+/**
+ * @brief 切换到指定阶段，此前所处阶段的耗时累加到该阶段名下。
+ *
+ * @param phase 切换到的阶段
+ * @return ProfilerPhase 切换前所处的阶段
+ */
+static inline ProfilerPhase profiler_enter(ProfilerPhase phase) {
+    if (!sim_config.config_profile) {
+        return phase;
+    }
+    uint64_t now = profiler_readTicks();
+    ProfilerPhase prev = profiler_state.phase;
+    profiler_state.ticks[prev] += now - profiler_state.lastTicks;
+    profiler_state.lastTicks = now;
+    profiler_state.phase = phase;
+    return prev;
+}
+
+/**
+ * @brief 在作用域内切换到指定阶段，离开作用域时切换回原阶段。
+ */
+class ProfilerScope {
+public:
+    explicit ProfilerScope(ProfilerPhase phase) : m_prev(profiler_enter(phase)) {}
+    ~ProfilerScope() { profiler_enter(m_prev); }
+
+    ProfilerScope(const ProfilerScope &) = delete;
+    ProfilerScope &operator=(const ProfilerScope &) = delete;
+
+private:
+    ProfilerPhase m_prev;
+};
+
+/**
+ * @brief 初始化性能分析器。需提前确保 sim_config 中相关配置信息已正确填入。
+ */
+void profiler_init();
+
+/**
+ * @brief 清零各阶段的耗时并重新开始计时。
+ */
+void profiler_reset();
+
+/**
+ * @brief 输出性能分析报告，若指定了 JSON 输出路径则同时追加一行 JSON 记录。
+ *
+ * @param cycles 至今仿真的时钟周期数
+ * @param insts 至今执行的指令数
+ * @param final 是否为仿真结束时的最终报告
+ */
+void profiler_report(uint64_t cycles, uint64_t insts, bool final);
+
+/**
+ * @brief 每执行完一条指令后调用，达到报告间隔时输出一次阶段性报告。
+ *
+ * @param cycles 至今仿真的时钟周期数
+ * @param insts 至今执行的指令数
+ */
+static inline void profiler_tick(uint64_t cycles, uint64_t insts) {
+    if (sim_config.config_profile && insts >= profiler_nextReportInsts) {
+        profiler_report(cycles, insts, false);
+    }
+}
+
+#endif /* __UTILS__PROFILER_HPP__ */
@@ -0,0 +1,26 @@
+#ifndef __UTILS__SAMPLER_HPP__
+#define __UTILS__SAMPLER_HPP__ 1
+
+#include <cstdint>
+#include <common.hpp>
+
+/**
+ * @brief 每执行完一条指令后调用，每隔若干条指令对 PC 及其 ftrace 调用栈采样一次。
+ *
+ * @param insts 至今执行的指令数
+ * @param pc 下一条指令的 PC
+ */
+void sampler_tick(uint64_t insts, addr_t pc);
+
+/**
+ * @brief 丢弃已有的全部采样。
+ */
+void sampler_reset();
+
+/**
+ * @brief 输出折叠调用栈（可交给 flamegraph.pl 生成火焰图），
+ * 并将各函数的自身/总计指令数表格打印到标准输出。
+ */
+void sampler_dump();
+
+#endif /* __UTILS__SAMPLER_HPP__ */
@@ -0,0 +1,65 @@
+#ifndef __WAVE_HPP__
+#define __WAVE_HPP__ 1
+
+#include <cstdint>
+#include <common.hpp>
+
+/*
+ * 波形记录。开启 NPC_CONFIG_WAVE 后按以下方式之一工作：
+ * 1. 完整记录：未指定任何触发条件时，从复位开始记录每个周期，与原先的行为一致；
+ * 2. 触发记录：由周期区间、PC 匹配、监视点触发或 SDB 命令开始记录，
+ *    记录 NPC_CONFIG_WAVE_WINDOW 个周期（为 0 则直到结束区间或手动停止）；
+ * 3. 飞行记录：每隔 NPC_CONFIG_WAVE_FLIGHT 个周期以 VerilatedSave 保存一次处理器快照，
+ *    并记录此后每次 eval() 的输入。仿真失败（ABORT、DiffTest 不一致或 HIT BAD TRAP）
+ *    或执行 SDB 命令 wave dump 时，从较早的快照重新仿真到当前周期，只为这一窗口输出波形。
+ *    PC 匹配与监视点触发时同样输出，但一次输出后 NPC_CONFIG_WAVE_FLIGHT 个周期内的再次触发被忽略。
+ */
+
+/**
+ * @brief 创建处理器模型后调用，按配置初始化波形记录。
+ *
+ * @return true 成功
+ * @return false 失败
+ */
+bool wave_init();
+
+/**
+ * @brief 每次 eval() 返回后调用，推进仿真时间并按需输出波形。
+ */
+void wave_onEval();
+
+/**
+ * @brief 每执行完一条指令后调用，检查各触发条件，飞行记录模式下按需保存快照。
+ *
+ * @param pc 下一条指令的地址
+ */
+void wave_onExec(addr_t pc);
+
+/**
+ * @brief 触发一次波形记录窗口。
+ *
+ * @param reason 触发原因，用于输出提示
+ */
+void wave_trigger(const char *reason);
+
+/**
+ * @brief 停止记录波形。
+ */
+void wave_stop();
+
+/**
+ * @brief 飞行记录模式下，重新仿真最近的窗口并输出波形，完成后恢复当前状态。
+ *
+ * @return true 成功
+ * @return false 失败
+ */
+bool wave_flightDump();
+
+/**
+ * @brief 仿真结束时调用，仿真失败时写出飞行记录的波形，并关闭波形文件。
+ *
+ * @param failed 仿真是否失败
+ */
+void wave_finalise(bool failed);
+
+#endif /* __WAVE_HPP__ */
@@ -8,67 +8,23 @@ module DPIAdapter (
     input logic         ecallEnable
 );
     /**
-     * 终止仿真
+     * 各触发信号的电平打包成的事件字，布局须与仿真环境 dpi.cpp 中的 DPIEvent 一致：
+     * [0] jal [1] jalr [2] ecall [3] 写使能 [4] 读使能 [5] 终止仿真 [8:6] 处理器阶段
      */
-    import "DPI-C" function void dpi_halt(
-        input logic halt
-    );
-    /**
-     * 触发指令 jal ，以记录 ftrace 日志
-     */
-    import "DPI-C" function void dpi_onInst_jal(
-        input logic         trig
-    );
-    /**
-     * 触发指令 jalr ，以记录 ftrace 日志
-     */
-    import "DPI-C" function void dpi_onInst_jalr(
-        input logic         trig
-    );
-    /**
-     * 触发内存写使能，通知后台仿真环境将处理器提供的数据写入主存
-     */
-    import "DPI-C" function void dpi_onMemWriteEnable(
-        input logic         memWriteEnable
-    );
-    /**
-     * 触发内存读使能，通知后台仿真环境读取主存提供给处理器
-     */
-    import "DPI-C" function void dpi_onMemReadEnable(
-        input logic         memReadEnable
-    );
-    /**
-     * 触发处理器阶段更新，通知后台仿真环境同步处理器阶段
-     */
-    import "DPI-C" function void dpi_onStage(
-        input logic [2:0]   stage
-    );
+    logic [31:0] events;
+    assign events = {23'b0, stage, halt, memReadEnable, memWriteEnable,
+                     ecallEnable, inst_jalr, inst_jal};
+
     /**
-     * 触发环境调用，以记录 etrace 日志
+     * 事件字变化时通知仿真环境。该函数有副作用，不能声明为 pure；
+     * 仿真环境中的实现只原子地保存事件字，待 eval() 返回后再统一处理，
+     * 因此可以安全地由多个线程并发调用，性能构建中使用 --threads-dpi all。
      */
-    import "DPI-C" function void dpi_onEcallEnable(
-        input logic         ecallEnable
+    import "DPI-C" function void dpi_onEvents(
+        input int unsigned  events
     );
 
-    always_ff @( posedge halt ) begin : call_dpi_halt
-        dpi_halt(halt);
-    end
-    always_ff @( posedge inst_jal ) begin : call_dpi_onInst_jal
-        dpi_onInst_jal(inst_jal);
-    end
-    always_ff @( posedge inst_jalr ) begin : call_dpi_onInst_jalr
-        dpi_onInst_jalr(inst_jalr);
-    end
-    always_ff @( posedge memWriteEnable ) begin : call_dpi_onMemWriteEnable
-        dpi_onMemWriteEnable(memWriteEnable);
-    end
-    always_ff @( posedge memReadEnable ) begin : call_dpi_onMemReadEnable
-        dpi_onMemReadEnable(memReadEnable);
-    end
-    always @( stage ) begin : call_dpi_onStage
-        dpi_onStage(stage);
-    end
-    always_ff @( posedge ecallEnable ) begin : call_dpi_onEcallEnable
-        dpi_onEcallEnable(ecallEnable);
+    always @( events ) begin : call_dpi_onEvents
+        dpi_onEvents(events);
     end
 endmodule
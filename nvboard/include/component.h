@@ -23,6 +23,7 @@ private:
   std::vector<SDL_Texture *> m_textures;
   int m_state;
   std::vector<uint16_t> pins;
+  bool m_dirty;
 
 public:
   Component(SDL_Renderer *rend, int cnt, int init_val, int ct);
@@ -44,6 +45,9 @@ public:
   void remove();
 
   friend void delete_components();
+  friend void init_dirty_components();
+  friend void mark_pin_dirty(uint16_t pin);
+  friend void update_components(SDL_Renderer *renderer);
 };
 
 #if 0
@@ -56,10 +60,8 @@ public:
 #endif
 
 class SEGS7 : public Component{
-private:
-  bool is_len8;
 public:
-  SEGS7(SDL_Renderer *rend, int cnt, int init_val, int ct, bool is_len8);
+  SEGS7(SDL_Renderer *rend, int cnt, int init_val, int ct);
   virtual void update_gui();
   virtual void update_state();
 };
@@ -68,6 +70,8 @@ void init_components(SDL_Renderer *renderer);
 void init_gui(SDL_Renderer *renderer);
 
 void add_component(Component *c);
+void init_dirty_components();
+void mark_pin_dirty(uint16_t pin);
 void update_components(SDL_Renderer *renderer);
 void delete_components();
 
@@ -14,6 +14,6 @@ SDL_Surface* ch2surface(uint8_t ch, uint32_t fg);
 SDL_Surface* ch2surface(uint8_t ch, uint32_t fg, uint32_t bg);
 SDL_Texture* ch2texture(SDL_Renderer *renderer, uint8_t ch, uint32_t fg);
 SDL_Texture* ch2texture(SDL_Renderer *renderer, uint8_t ch, uint32_t fg, uint32_t bg);
-SDL_Texture* ch2texture_term(uint8_t ch);
+void draw_glyphs(SDL_Renderer *renderer, const uint8_t *str, int len, int x, int y, uint32_t fg);
 
 #endif
@@ -6,6 +6,9 @@
 
 #define NOT_A_KEY -1
 #define CLK_NUM 10
+// half period of PS/2 clock in transactor mode: each level is held for 3
+// cycles, which still passes the usual 3-flop synchronizer of the RTL
+#define CLK_NUM_TRANSACTOR 2
 #define PS2_START 0
 #define PS2_DATA_0 1
 #define PS2_DATA_7 8
@@ -21,12 +24,15 @@ class KEYBOARD : public Component{
     std::queue <uint8_t> all_keys;
     int data_idx;
     int left_clk;
+    int clk_num;
     int cur_key;
 
   public:
     KEYBOARD(SDL_Renderer *rend, int cnt, int init_val, int ct);
     ~KEYBOARD();
     void push_key(uint8_t scancode, bool is_keydown);
+    void enqueue_key(uint8_t scancode, bool is_keydown);
+    void load_script(const char *path);
     virtual void update_state();
 };
 
@@ -7,12 +7,15 @@
 #include <component.h>
 #include <configs.h>
 #include <string>
+#include <functional>
 #include <SDL.h>
 #include <SDL_image.h>
 
 #define VERSION_STR "v1.0 (2024.01.10)"
 
 void set_redraw();
+void post_to_sim_thread(std::function<void()> task);
+void post_pin_poke(uint16_t pin, int val);
 uint64_t nvboard_get_time();
 
 void init_render(SDL_Renderer *renderer);
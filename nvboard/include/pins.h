@@ -13,6 +13,19 @@ typedef struct PinNode {
 } PinNode;
 extern PinNode pin_array[];
 
+// consecutive pins bound to bits [offset + len - 1 : offset] of one signal,
+// indexed by the pin of the lowest bit
+typedef struct PinGroup {
+  void *ptr;
+  uint8_t size;
+  uint8_t len;
+  uint8_t offset;
+} PinGroup;
+extern PinGroup pin_group[];
+
+// pin values published by the simulation thread, only read by the render thread
+extern uint8_t *pin_snapshot;
+
 static inline uint8_t pin_peek(int pin) {
   PinNode *p = &pin_array[pin];
   if (p->vector_len == 1) {
@@ -29,6 +42,22 @@ static inline uint8_t pin_peek8(int pin) {
   return *(uint8_t *)p->ptr;
 }
 
+static inline uint64_t pin_group_peek(int lsb_pin) {
+  PinGroup *g = &pin_group[lsb_pin];
+  uint64_t v;
+  switch (g->size) {
+    case 1: v = *(uint8_t *)g->ptr; break;
+    case 2: v = *(uint16_t *)g->ptr; break;
+    case 4: v = *(uint32_t *)g->ptr; break;
+    default: v = *(uint64_t *)g->ptr; break;
+  }
+  return (v >> g->offset) & ((1ull << g->len) - 1);
+}
+
+static inline uint8_t pin_snapshot_peek(int pin) {
+  return pin_snapshot[pin];
+}
+
 static inline void pin_poke(int pin, uint64_t v) {
   PinNode *p = &pin_array[pin];
   if (p->vector_len == 1) {
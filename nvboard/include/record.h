@@ -0,0 +1,47 @@
+#ifndef __RECORD_H__
+#define __RECORD_H__
+
+#include <stdint.h>
+
+// Binary log of the board outputs, enabled by NVBOARD_RECORD=<path>.
+// The file starts with a RecordHeader, followed by RecordEntry items.
+// Timestamps are counted in calls to nvboard_update(), so a log only depends
+// on the simulated design and can be compared against a golden one with
+// scripts/nvboard_record.py.
+
+#define RECORD_MAGIC   "NVBREC\0"
+#define RECORD_VERSION 1
+#define RECORD_DEFAULT_INTERVAL 1000 // cycles between two samples of LEDs and 7-segs
+
+enum { // record type
+  RECORD_LED = 1,   // value: LD15..LD0
+  RECORD_SEG7,      // index: digit, value: segments in the same order as SEGS7
+  RECORD_UART,      // value: byte received from UART_TX
+  RECORD_VGA,       // value: FNV-1a hash of a frame which differs from the previous one
+};
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t interval;
+} RecordHeader;
+
+typedef struct {
+  uint64_t cycle;
+  uint8_t type;
+  uint8_t index;
+  uint16_t reserved;
+  uint32_t value;
+} RecordEntry;
+
+extern uint64_t nvboard_cycles;
+extern int64_t record_sample_cnt;
+
+void init_record();
+void finish_record();
+bool is_recording();
+void record_event(int type, int index, uint32_t value);
+void record_sample();
+uint32_t record_hash(const uint32_t *pixels, int n);
+
+#endif
@@ -10,10 +10,14 @@ private:
   Term *term;
   int tx_state, rx_state;
   uint16_t divisor;
+  bool transactor;
   uint8_t tx_data, rx_data;
   std::string rx_sending_str;
+  std::string tx_pending;   // owned by the simulation thread
+  std::string tx_published; // handed over through the snapshot mailbox
   bool need_update_gui;
   uint8_t *p_tx;
+  FILE *host_out;
 public:
   UART(SDL_Renderer *rend, int cnt, int init_val, int ct, int x, int y, int w, int h);
   ~UART();
@@ -24,6 +28,8 @@ public:
   void tx_receive();
   void rx_send();
   void rx_getchar(uint8_t ch);
+  void publish();
+  void acquire();
   void term_focus(bool v);
 };
 
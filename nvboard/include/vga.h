@@ -2,6 +2,8 @@
 #define __VGA_H__
 
 #include <component.h>
+#include <atomic>
+#include <mutex>
 
 #define VGA_DEFAULT_WIDTH  640
 #define VGA_DEFAULT_HEIGHT 480
@@ -18,16 +20,29 @@ struct VGA_MODE{
 class VGA : public Component{
 private:
   int vga_screen_width, vga_screen_height;
-  uint32_t *pixels;
+  uint32_t *pixels;       // frame being scanned by the simulation thread
+  uint32_t *pixels_front; // last finished frame, uploaded by the render thread
+  uint32_t *line;         // staging buffer of the current scanline
+  bool *row_dirty;        // rows of `pixels` changed in the current frame
+  bool *front_row_dirty;  // rows of `pixels_front` not uploaded yet
+  bool is_frame_dirty;
+  std::mutex frame_lock;
+  std::atomic<bool> is_frame_ready;
   int vga_clk_cnt;
+  int line_y;
   uint32_t *p_pixel;
-  uint32_t *p_pixel_end;
+  uint32_t *p_line_end;
   uint8_t *p_r, *p_g, *p_b;
   bool is_r_len8, is_g_len8, is_b_len8;
   bool is_all_len8;
-  bool is_pixels_same;
+  bool is_r_group, is_g_group, is_b_group;
+  void *p_rgb;
+  int rgb_offset;
+  bool is_rgb_64;
+  bool is_rgb_packed;
 
   uint32_t get_pixel_color_slowpath();
+  void finish_one_line();
   void finish_one_frame();
 
 public:
@@ -14,7 +14,7 @@ class BoardDescParser():
       print(f"Board Line {lid}: Error: Invalid pin direction \"{direction}\"")
       exit(-1)
     
-    self.pins[pinname] = 1
+    self.pins[pinname] = direction
   
   def parseFile(self, path):
     self.pins = {}
@@ -39,6 +39,9 @@ class BoardDescParser():
   def checkPinValid(self, pin):
     return pin in self.pins
 
+  def isOutputPin(self, pin):
+    return self.pins.get(pin) == "output"
+
 
 class NxdcParser():
   def __init__(self) -> None:
@@ -129,6 +132,7 @@ class IndentWriter():
       self.inside_comment = True
       wrline = wrline[cmtInd:]
     
+    indclose = 0
     if not self.inside_comment:
         if '{' in wrline:
           indclose = wrline[:wrline.find('{')].count('}')
@@ -139,7 +143,7 @@ class IndentWriter():
           print("Internal Error: Indent level closed beyond 0")
           exit(-1)
     
-    if self.newline:
+    if self.newline and wrline != '\n':
       self.fp.write('\t'*(self.indent_level-indclose) )
     
     self.fp.write(wrline)
@@ -158,26 +162,41 @@ class IndentWriter():
     self.writeline(wrlines[-1])
 
 
+# Pin groups read as a whole by NVBoard components, listed from MSB to LSB
+PIN_GROUPS = [
+  ("VGA_R", [f"VGA_R{i}" for i in range(7, -1, -1)]),
+  ("VGA_G", [f"VGA_G{i}" for i in range(7, -1, -1)]),
+  ("VGA_B", [f"VGA_B{i}" for i in range(7, -1, -1)]),
+]
+
 class AutoBindWriter():
   def __init__(self, iwriter, board):
     self.iw = iwriter
     self.board = board
+    self.output_signals = []
+    self.signals = []
   
   def bindPin(self, signal, pin):
     if not self.board.checkPinValid(pin):
       print(f"Error: Invalid pin {pin}")
       exit(1)
-    self.iw.write(f"nvboard_bind_pin( &top->{signal}, 1, {pin});\n")
+    self.iw.write(f"nvboard_bind_pin( &nvboard_signals::{signal}::port(top), nvboard_signals::{signal}::width, {pin});\n")
+    self.signals.append( (signal, [pin]) )
+    if self.board.isOutputPin(pin):
+      self.output_signals.append(signal)
   
   def bindVec(self, signal, pins):
     for pin in pins:
       if not self.board.checkPinValid(pin):
         print(f"Error: Invalid pin {pin}")
         exit(1)
-    self.iw.write(f"nvboard_bind_pin( &top->{signal}, {len(pins)}")
+    self.iw.write(f"nvboard_bind_pin( &nvboard_signals::{signal}::port(top), nvboard_signals::{signal}::width")
     for pin in pins:
       self.iw.write(f", {pin}")
     self.iw.write(");\n")
+    self.signals.append( (signal, pins) )
+    if all(self.board.isOutputPin(pin) for pin in pins):
+      self.output_signals.append(signal)
   
   def bind(self, signal, pin):
     if type(pin) is list:
@@ -188,22 +207,88 @@ class AutoBindWriter():
       print(f"Error: Invalid bind from {signal} to {pin}")
       exit(-1)
 
-  def writeHead(self, top):
+  def writeHead(self, top, header):
     self.iw.write( (
     "#include <nvboard.h>\n"
-    f'#include "V{top}.h"\n'
+    f'#include "{header}"\n'
     "\n"
     f"void nvboard_bind_all_pins(V{top}* top) {{\n"
     ) )
   
+  def writeShadow(self):
+    # Output signals are copied into a compact shadow buffer every frame,
+    # so that only the components whose pins changed get updated
+    if len(self.output_signals) == 0:
+      return
+    self.iw.write("\n// shadow copy of output signals for change detection\n")
+    self.iw.write("void nvboard_bind_shadow(void *signal, int size);\n")
+    for signal in self.output_signals:
+      self.iw.write(f"nvboard_bind_shadow( &nvboard_signals::{signal}::port(top), sizeof(nvboard_signals::{signal}::type));\n")
+
+  def findGroups(self):
+    # A group can be read with a single load if all of its pins are bound
+    # to consecutive bits of the same signal, no matter how many other pins
+    # share that signal
+    groups = []
+    for name, gpins in PIN_GROUPS:
+      for signal, pins in self.signals:
+        if gpins[-1] not in pins:
+          continue
+        last = pins.index(gpins[-1])
+        first = last - len(gpins) + 1
+        if first >= 0 and pins[first:last+1] == gpins and len(pins) <= 64:
+          groups.append( (name, gpins, signal, len(pins) - 1 - last) )
+        break
+    return groups
+
+  def writeGroups(self):
+    groups = self.findGroups()
+    if len(groups) == 0:
+      return
+    self.iw.write("\n// pin groups read with a single load by NVBoard components\n")
+    self.iw.write("void nvboard_bind_group(int lsb_pin, int len, void *signal, int size, int offset);\n")
+    for name, gpins, _, _ in groups:
+      self.iw.write(f"nvboard_bind_group({gpins[-1]}, nvboard_groups::{name}::width, "
+        f"&nvboard_groups::{name}::signal::port(top), "
+        f"sizeof(nvboard_groups::{name}::signal::type), nvboard_groups::{name}::offset);\n")
+
+  def writeHeader(self, path, top):
+    # Typed descriptors of the bound signals, used by the generated binding
+    # code. Verilator ports are reference members of the model class, so they
+    # are reached through an accessor instead of a pointer to member.
+    guard = "__NVBOARD_" + os.path.basename(path).upper().replace('.', '_') + "__"
+    with open(path, "w") as f:
+      f.write(f"// Generated by auto_pin_bind.py, do not edit\n")
+      f.write(f"#ifndef {guard}\n#define {guard}\n\n")
+      f.write(f'#include "V{top}.h"\n#include <type_traits>\n\n')
+      f.write("namespace nvboard_signals {\n")
+      for signal, pins in self.signals:
+        f.write(f"\n// {', '.join(pins)}\n")
+        f.write(f"struct {signal} {{\n")
+        f.write(f"  typedef std::remove_reference<decltype(((V{top} *)0)->{signal})>::type type;\n")
+        f.write(f"  static constexpr int width = {len(pins)};\n")
+        f.write(f"  static type &port(V{top} *top) {{ return top->{signal}; }}\n")
+        f.write("};\n")
+      f.write("\n} // namespace nvboard_signals\n\n")
+      f.write("namespace nvboard_groups {\n")
+      for name, gpins, signal, offset in self.findGroups():
+        width = len(gpins)
+        f.write(f"\n// {gpins[0]}..{gpins[-1]} = {signal}[{offset + width - 1}:{offset}]\n")
+        f.write(f"struct {name} {{\n")
+        f.write(f"  typedef nvboard_signals::{signal} signal;\n")
+        f.write(f"  static constexpr int width = {width};\n")
+        f.write(f"  static constexpr int offset = {offset};\n")
+        f.write("};\n")
+      f.write("\n} // namespace nvboard_groups\n\n#endif\n")
+
   def writeTail(self):
     self.iw.write("}\n")
 
 def print_usage():
-  print("Usage: python3 auto_pin_bind.py nxdc_constraint_file_path auto_bind_c_output_file_path")
+  print("Usage: python3 auto_pin_bind.py nxdc_constraint_file_path auto_bind_c_output_file_path [auto_bind_h_output_file_path]")
 
 if __name__ == "__main__":
-  if len(sys.argv) != 3:
+  if len(sys.argv) not in (3, 4):
     print("Error: Bad command line arguments")
     print_usage()
     exit(-1)
@@ -215,6 +300,7 @@ if __name__ == "__main__":
   
   cons_path = sys.argv[1]
   output_path = sys.argv[2]
+  header_path = sys.argv[3] if len(sys.argv) == 4 else os.path.splitext(output_path)[0] + ".h"
   boardfile_path = os.path.join(nvboard_path, "board/N4")
 
   if not os.path.exists(cons_path):
@@ -240,9 +326,12 @@ if __name__ == "__main__":
   
   abw = AutoBindWriter(bind_wr, board)
   
-  abw.writeHead(constr.toplevel)
+  abw.writeHead(constr.toplevel, os.path.relpath(header_path, os.path.dirname(os.path.abspath(output_path))))
   for signal, pin in constr.binds:
     abw.bind(signal, pin)
+  abw.writeShadow()
+  abw.writeGroups()
   abw.writeTail()
   
   bind_wr.close()
+  abw.writeHeader(header_path, constr.toplevel)
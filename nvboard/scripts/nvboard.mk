@@ -5,12 +5,22 @@ NVBOARD_INC = $(NVBOARD_HOME)/include
 NVBOARD_USR_INC = $(NVBOARD_HOME)/usr/include
 INC_PATH += $(NVBOARD_USR_INC)
 
+# Set NVBOARD_HEADLESS=1 to build NVBoard without window and render thread,
+# e.g. for running board-level tests on servers without X
+ifeq ($(NVBOARD_HEADLESS),1)
+NVBOARD_BUILD_DIR = $(NVBOARD_HOME)/build-headless
+CXXFLAGS += -DNVBOARD_HEADLESS
+# sources which only draw the board are left out, so that SDL is not linked
+NVBOARD_GUI_SRCS = button event font led render segs7 switch term
+NVBOARD_SRCS := $(filter-out $(addprefix $(NVBOARD_SRC)/, $(addsuffix .cpp, $(NVBOARD_GUI_SRCS))), $(NVBOARD_SRCS))
+else
 NVBOARD_BUILD_DIR = $(NVBOARD_HOME)/build
+endif
 NVBOARD_OBJS := $(addprefix $(NVBOARD_BUILD_DIR)/, $(addsuffix .o, $(basename $(notdir $(NVBOARD_SRCS)))))
 
 # The archive of NVBoard
 NVBOARD_ARCHIVE = $(NVBOARD_BUILD_DIR)/nvboard.a
-CXXFLAGS += -MMD -O3 $(shell sdl2-config --cflags)
+CXXFLAGS += -MMD -O3 -pthread $(shell sdl2-config --cflags)
 
 $(NVBOARD_BUILD_DIR)/%.o: $(NVBOARD_SRC)/%.cpp
 	@echo + CXX "->" NVBOARD_HOME/$(shell realpath $< --relative-to $(NVBOARD_HOME))
@@ -26,11 +36,15 @@ $(NVBOARD_ARCHIVE): $(NVBOARD_OBJS)
 -include $(NVBOARD_OBJS:.o=.d)
 
 # Link flags for examples
-LDFLAGS += $(shell sdl2-config --libs) -lSDL2_image -lSDL2_ttf
+ifeq ($(NVBOARD_HEADLESS),1)
+LDFLAGS += -pthread
+else
+LDFLAGS += $(shell sdl2-config --libs) -lSDL2_image -lSDL2_ttf -pthread
+endif
 
 .PHONY: nvboard-archive nvboard-clean
 
 nvboard-archive: $(NVBOARD_ARCHIVE)
 
 nvboard-clean:
-	rm -rf $(NVBOARD_BUILD_DIR)
+	rm -rf $(NVBOARD_HOME)/build $(NVBOARD_HOME)/build-headless
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+import sys
+import struct
+
+# Keep in sync with include/record.h
+RECORD_MAGIC = b"NVBREC\0\0"
+RECORD_VERSION = 1
+HEADER_FMT = "<8sII"
+ENTRY_FMT = "<QBBHI"
+
+RECORD_TYPES = { 1: "LED", 2: "SEG7", 3: "UART", 4: "VGA" }
+
+class Record():
+  def __init__(self, path):
+    self.interval = 0
+    self.entries = []
+    self.parseFile(path)
+
+  def parseFile(self, path):
+    with open(path, "rb") as f:
+      data = f.read()
+
+    hsize = struct.calcsize(HEADER_FMT)
+    if len(data) < hsize:
+      print(f"Error: {path}: File too short")
+      exit(2)
+    magic, version, self.interval = struct.unpack_from(HEADER_FMT, data, 0)
+    if magic != RECORD_MAGIC or version != RECORD_VERSION:
+      print(f"Error: {path}: Not an NVBoard record (version {RECORD_VERSION})")
+      exit(2)
+
+    esize = struct.calcsize(ENTRY_FMT)
+    for off in range(hsize, len(data) - esize + 1, esize):
+      cycle, rtype, index, _, value = struct.unpack_from(ENTRY_FMT, data, off)
+      self.entries.append( (cycle, rtype, index, value) )
+
+  def stream(self, rtype):
+    return [e for e in self.entries if e[1] == rtype]
+
+
+def formatEntry(e):
+  cycle, rtype, index, value = e
+  name = RECORD_TYPES.get(rtype, f"TYPE{rtype}")
+  if rtype == 1:
+    return f"{cycle:>12} {name:<5} {value:016b}"
+  elif rtype == 2:
+    return f"{cycle:>12} {name:<5} [{index}] {value:08b}"
+  elif rtype == 3:
+    ch = chr(value) if 0x20 <= value < 0x7f else f"\\x{value:02x}"
+    return f"{cycle:>12} {name:<5} {ch}"
+  else:
+    return f"{cycle:>12} {name:<5} {value:08x}"
+
+def dump(path):
+  rec = Record(path)
+  print(f"# interval = {rec.interval} cycles")
+  for e in rec.entries:
+    print(formatEntry(e))
+  return 0
+
+def compare(golden_path, actual_path, tolerance):
+  golden = Record(golden_path)
+  actual = Record(actual_path)
+
+  # Each output is compared on its own, so that e.g. UART bytes arriving
+  # earlier than a LED change do not count as a mismatch
+  ok = True
+  for rtype, name in RECORD_TYPES.items():
+    g = golden.stream(rtype)
+    a = actual.stream(rtype)
+    for i in range(max(len(g), len(a))):
+      if i >= len(g) or i >= len(a):
+        print(f"{name}: {'golden' if i >= len(a) else 'actual'} has extra events from #{i}:")
+        print("  " + formatEntry(g[i] if i < len(g) else a[i]))
+        ok = False
+        break
+      if g[i][1:] != a[i][1:] or (tolerance >= 0 and abs(g[i][0] - a[i][0]) > tolerance):
+        print(f"{name}: mismatch at event #{i}")
+        print("  golden: " + formatEntry(g[i]))
+        print("  actual: " + formatEntry(a[i]))
+        ok = False
+        break
+
+  print("PASS" if ok else "FAIL")
+  return 0 if ok else 1
+
+def print_usage():
+  print("Usage: python3 nvboard_record.py dump record_file")
+  print("       python3 nvboard_record.py cmp golden_record_file record_file [cycle_tolerance]")
+  print("         cycle_tolerance: maximal timestamp difference per event, -1 to ignore (default: 0)")
+
+if __name__ == "__main__":
+  if len(sys.argv) == 3 and sys.argv[1] == "dump":
+    exit(dump(sys.argv[2]))
+  elif len(sys.argv) in (4, 5) and sys.argv[1] == "cmp":
+    tolerance = int(sys.argv[4]) if len(sys.argv) == 5 else 0
+    exit(compare(sys.argv[2], sys.argv[3], tolerance))
+  else:
+    print("Error: Bad command line arguments")
+    print_usage()
+    exit(-1)
@@ -7,6 +7,7 @@ Component::Component(SDL_Renderer *rend, int cnt, int init_val, int ct) {
   m_rects.resize(cnt);
   m_textures.resize(cnt);
   m_state = init_val;
+  m_dirty = false;
 }
 
 bool Component::in_rect(int x, int y) const{
@@ -57,13 +58,15 @@ void Component::add_pin(const uint16_t pin) {
 }
 
 void Component::update_gui() {
+#ifndef NVBOARD_HEADLESS
   SDL_RenderCopy(m_renderer, m_textures[m_state], NULL, m_rects[m_state]);
   set_redraw();
+#endif
 }
 
 void Component::update_state() {
   uint16_t pin = *(pins.begin());
-  int newval = pin_peek(pin);
+  int newval = pin_snapshot_peek(pin);
   if (newval != m_state) {
     set_state(newval);
     update_gui();
@@ -95,13 +98,18 @@ void RGB_LED::update_state() {
 }
 #endif
 
+#ifndef NVBOARD_HEADLESS
 void init_components(SDL_Renderer *renderer) {
 #define COMPONENT_LIST(f) f(led) f(switch) f(button) f(segs7) f(keyboard) f(vga) f(uart)
 #define INIT_FN(c) { void concat(init_, c)(SDL_Renderer *); concat(init_, c)(renderer); }
   COMPONENT_LIST(INIT_FN);
 }
+#endif
 
 std::vector<Component *> components;
+static Component *pin_owner[NR_PINS] = {};
+static std::vector<Component *> dirty_components;
+static std::vector<Component *> polled_components;
 
 void add_component(Component *c) {
   components.push_back(c);
@@ -116,10 +124,39 @@ void delete_components() {
 }
 
 // render buttons, switches, leds and 7-segs
+#ifndef NVBOARD_HEADLESS
 void init_gui(SDL_Renderer *renderer) {
   for (auto ptr : components) { ptr->update_gui(); }
 }
+#endif
+
+// Components are only updated when one of their pins changes, except
+// those which have to be polled every frame
+void init_dirty_components() {
+  dirty_components.clear();
+  polled_components.clear();
+  for (auto ptr : components) {
+    for (auto pin : ptr->pins) { pin_owner[pin] = ptr; }
+    if (ptr->get_component_type() == UART_TYPE) polled_components.push_back(ptr);
+    else {
+      ptr->m_dirty = true;
+      dirty_components.push_back(ptr);
+    }
+  }
+}
+
+void mark_pin_dirty(uint16_t pin) {
+  Component *ptr = pin_owner[pin];
+  if (ptr == NULL || ptr->m_dirty) return;
+  ptr->m_dirty = true;
+  dirty_components.push_back(ptr);
+}
 
 void update_components(SDL_Renderer *renderer) {
-  for (auto ptr : components) { ptr->update_state(); }
+  for (auto ptr : dirty_components) {
+    ptr->m_dirty = false;
+    ptr->update_state();
+  }
+  dirty_components.clear();
+  for (auto ptr : polled_components) { ptr->update_state(); }
 }
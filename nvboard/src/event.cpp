@@ -1,13 +1,26 @@
-#include <SDL.h>
-#include <component.h>
-#include <pins.h>
+#include <nvboard.h>
 
 extern std::vector<Component *> components;
 void uart_rx_getchar(uint8_t ch);
 void uart_term_focus(bool v);
 void kb_push_key(uint8_t scancode, bool is_keydown);
+void nvboard_quit();
 static bool uart_term_get_focus = false;
 
+// Closing the window ends the program. The exit runs on the simulation
+// thread, but only after nvboard_quit() has stopped and joined the render
+// thread, so that static destructors do not race with a renderer still
+// using SDL.
+static void request_quit() {
+  static bool quit_requested = false;
+  if (quit_requested) return;
+  quit_requested = true;
+  post_to_sim_thread([]() {
+    nvboard_quit();
+    exit(0);
+  });
+}
+
 static void mousedown_handler(const SDL_Event &ev) {
   int x_pos = ev.button.x;
   int y_pos = ev.button.y;
@@ -15,8 +28,8 @@ static void mousedown_handler(const SDL_Event &ev) {
   for (auto i : components) {
     if (i->in_rect(x_pos, y_pos)) {
       switch (i->get_component_type()) {
-        case BUTTON_TYPE: pin_poke(i->get_pin(), 1); break;
-        case SWITCH_TYPE: pin_poke(i->get_pin(), i->get_state() ^ 1); break;
+        case BUTTON_TYPE: post_pin_poke(i->get_pin(), 1); break;
+        case SWITCH_TYPE: post_pin_poke(i->get_pin(), i->get_state() ^ 1); break;
         case UART_TYPE: click_uart_term = true; break;
       }
     }
@@ -35,7 +48,7 @@ static void mouseup_handler(const SDL_Event &ev) {
   for (auto i : components) {
     if (i->in_rect(x_pos, y_pos)) {
       switch (i->get_component_type()) {
-        case BUTTON_TYPE: pin_poke(i->get_pin(), 0); break;
+        case BUTTON_TYPE: post_pin_poke(i->get_pin(), 0); break;
       }
     }
   }
@@ -45,9 +58,9 @@ void read_event() {
   SDL_Event ev;
   while (SDL_PollEvent(&ev)) {
     switch (ev.type) {
-      case SDL_QUIT: exit(0);
+      case SDL_QUIT: request_quit(); break;
       case SDL_WINDOWEVENT:
-        if (ev.window.event == SDL_WINDOWEVENT_CLOSE) { exit(0); }
+        if (ev.window.event == SDL_WINDOWEVENT_CLOSE) { request_quit(); }
         break;
       case SDL_MOUSEBUTTONDOWN: mousedown_handler(ev); break;
       case SDL_MOUSEBUTTONUP: mouseup_handler(ev); break;
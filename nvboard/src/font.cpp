@@ -2,7 +2,8 @@
 #include <SDL_ttf.h>
 
 static TTF_Font *font = NULL;
-static SDL_Texture* font_texture_term[128] = { NULL };
+// all ASCII glyphs rendered in white, recolored with SDL_SetTextureColorMod()
+static SDL_Texture* glyph_atlas = NULL;
 SDL_Texture* surface2texture(SDL_Renderer *renderer, SDL_Surface *s);
 SDL_Texture *nvboard_texture = NULL;
 
@@ -18,13 +19,35 @@ void init_font(SDL_Renderer *renderer) {
   nvboard_texture = str2texture(renderer, "NVBoard", 0xffffff, BOARD_BG_COLOR);
 
   TTF_SetFontSize(font, CH_HEIGHT);
-  SDL_Color fg = {.r = 0x00, .g = 0x00, .b = 0x00 };
-  SDL_Color bg = {.r = 0xff, .g = 0xff, .b = 0xff };
+  SDL_Color white = {.r = 0xff, .g = 0xff, .b = 0xff, .a = 0xff };
+  SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, CH_WIDTH * 128, CH_HEIGHT,
+      32, SDL_PIXELFORMAT_ARGB8888);
+  assert(atlas != NULL);
   for (int i = 1; i < 128; i ++) {
-    SDL_Surface *s = TTF_RenderGlyph_Shaded(font, i, fg, bg);
+    SDL_Surface *s = TTF_RenderGlyph_Blended(font, i, white);
+    if (s == NULL) continue;
     assert(s->w == CH_WIDTH);
     assert(s->h == CH_HEIGHT);
-    font_texture_term[i] = surface2texture(renderer, s);
+    SDL_SetSurfaceBlendMode(s, SDL_BLENDMODE_NONE);
+    SDL_Rect r = Rect(i * CH_WIDTH, 0, CH_WIDTH, CH_HEIGHT);
+    SDL_BlitSurface(s, NULL, atlas, &r);
+    SDL_FreeSurface(s);
+  }
+  glyph_atlas = surface2texture(renderer, atlas);
+  SDL_SetTextureBlendMode(glyph_atlas, SDL_BLENDMODE_BLEND);
+}
+
+// Draw `len` characters of `str` with glyphs from the atlas. All copies come
+// from the same texture, so SDL can batch them into a few draw calls.
+void draw_glyphs(SDL_Renderer *renderer, const uint8_t *str, int len, int x, int y, uint32_t fg) {
+  SDL_SetTextureColorMod(glyph_atlas, (uint8_t)(fg >> 16), (uint8_t)(fg >> 8), (uint8_t)fg);
+  SDL_Rect src = Rect(0, 0, CH_WIDTH, CH_HEIGHT);
+  SDL_Rect dst = Rect(x, y, CH_WIDTH, CH_HEIGHT);
+  for (int i = 0; i < len; i ++, dst.x += CH_WIDTH) {
+    uint8_t ch = str[i];
+    if (ch == 0 || ch == ' ' || ch >= 128) continue;
+    src.x = ch * CH_WIDTH;
+    SDL_RenderCopy(renderer, glyph_atlas, &src, &dst);
   }
 }
 
@@ -74,11 +97,6 @@ SDL_Texture* ch2texture(SDL_Renderer *renderer, uint8_t ch, uint32_t fg, uint32_
   return surface2texture(renderer, ch2surface(ch, fg, bg));
 }
 
-SDL_Texture* ch2texture_term(uint8_t ch) {
-  assert(ch < 128);
-  return font_texture_term[ch == 0 ? ' ' : ch];
-}
-
 void close_font() {
   TTF_CloseFont(font);
   TTF_Quit();
@@ -15,10 +15,19 @@ static Key keys[256] = {};
 
 KEYBOARD::KEYBOARD(SDL_Renderer *rend, int cnt, int init_val, int ct):
   Component(rend, cnt, init_val, ct),
-  data_idx(0), left_clk(0), cur_key(NOT_A_KEY) { }
+  data_idx(0), left_clk(0), clk_num(CLK_NUM), cur_key(NOT_A_KEY) {
+  // PS/2 has no flow control towards the host, so the fastest rate is the
+  // one the receiver in the RTL can still sample. NVBOARD_KB_CLK overrides
+  // the half period (in cycles of nvboard_update()) picked by the mode.
+  const char *fast = getenv("NVBOARD_TRANSACTOR");
+  if (fast != NULL && strcmp(fast, "1") == 0) clk_num = CLK_NUM_TRANSACTOR;
+  const char *clk = getenv("NVBOARD_KB_CLK");
+  if (clk != NULL && atoi(clk) >= 0) clk_num = atoi(clk);
+}
 
 
-void KEYBOARD::push_key(uint8_t sdl_key, bool is_keydown){
+// called by the simulation thread
+void KEYBOARD::enqueue_key(uint8_t sdl_key, bool is_keydown){
   Key *e = &keys[sdl_key];
   uint8_t at_key = e->map0;
   if(at_key == 0xe0){
@@ -28,13 +37,76 @@ void KEYBOARD::push_key(uint8_t sdl_key, bool is_keydown){
   if(!is_keydown) all_keys.push(0xf0);
   all_keys.push(at_key);
   is_kb_idle = false;
+}
+
+#ifndef NVBOARD_HEADLESS
+// called by the render thread
+void KEYBOARD::push_key(uint8_t sdl_key, bool is_keydown){
+  post_to_sim_thread([this, sdl_key, is_keydown]() { enqueue_key(sdl_key, is_keydown); });
 
+  Key *e = &keys[sdl_key];
   if (e->pressing != is_keydown) {
     e->pressing = is_keydown;
     SDL_RenderCopy(get_renderer(), (is_keydown ? e->t_down : e->t_up), NULL, &e->rect);
     set_redraw();
   }
 }
+#endif
+
+// map an ASCII character to the key typing it on a US layout
+static int ascii2scancode(char ch, bool *shift) {
+  static const char *shifted   = "~!@#$%^&*()_+{}|:\"<>?";
+  static const char *unshifted = "`1234567890-=[]\\;',./";
+  const char *p = (ch != '\0') ? strchr(shifted, ch) : NULL;
+  *shift = (p != NULL) || (ch >= 'A' && ch <= 'Z');
+  if (p != NULL) ch = unshifted[p - shifted];
+  if (ch >= 'A' && ch <= 'Z') ch += 'a' - 'A';
+
+  if (ch >= 'a' && ch <= 'z') return SDL_SCANCODE_A + (ch - 'a');
+  if (ch >= '1' && ch <= '9') return SDL_SCANCODE_1 + (ch - '1');
+  switch (ch) {
+    case '0':  return SDL_SCANCODE_0;
+    case '`':  return SDL_SCANCODE_GRAVE;
+    case '-':  return SDL_SCANCODE_MINUS;
+    case '=':  return SDL_SCANCODE_EQUALS;
+    case '[':  return SDL_SCANCODE_LEFTBRACKET;
+    case ']':  return SDL_SCANCODE_RIGHTBRACKET;
+    case '\\': return SDL_SCANCODE_BACKSLASH;
+    case ';':  return SDL_SCANCODE_SEMICOLON;
+    case '\'': return SDL_SCANCODE_APOSTROPHE;
+    case ',':  return SDL_SCANCODE_COMMA;
+    case '.':  return SDL_SCANCODE_PERIOD;
+    case '/':  return SDL_SCANCODE_SLASH;
+    case ' ':  return SDL_SCANCODE_SPACE;
+    case '\n': return SDL_SCANCODE_RETURN;
+    case '\t': return SDL_SCANCODE_TAB;
+    case '\b': return SDL_SCANCODE_BACKSPACE;
+    case 27:   return SDL_SCANCODE_ESCAPE;
+    default:   return -1;
+  }
+}
+
+// Type the content of a text file: each character becomes a key press and
+// release (with shift when needed). All scancodes are queued at once, so
+// they are sent back to back at the rate set by clk_num.
+void KEYBOARD::load_script(const char *path) {
+  FILE *fp = fopen(path, "r");
+  if (fp == NULL) {
+    printf("NVBoard: cannot open keyboard script %s\n", path);
+    return;
+  }
+  int c;
+  while ((c = fgetc(fp)) != EOF) {
+    bool shift;
+    int key = ascii2scancode(c, &shift);
+    if (key < 0) continue;
+    if (shift) enqueue_key(SDL_SCANCODE_LSHIFT, true);
+    enqueue_key(key, true);
+    enqueue_key(key, false);
+    if (shift) enqueue_key(SDL_SCANCODE_LSHIFT, false);
+  }
+  fclose(fp);
+}
 
 void KEYBOARD::update_state(){
   if(cur_key == NOT_A_KEY){
@@ -44,14 +116,14 @@ void KEYBOARD::update_state(){
     }
     cur_key = all_keys.front();
     assert(data_idx == 0);
-    left_clk = CLK_NUM;
+    left_clk = clk_num;
   }
 
   if(left_clk == 0){
     uint8_t ps2_clk = pin_peek(PS2_CLK);
     ps2_clk = !ps2_clk;
     pin_poke(PS2_CLK, ps2_clk);
-    left_clk = CLK_NUM;
+    left_clk = clk_num;
     if(ps2_clk){
       assert(!all_keys.empty());
       uint8_t ps2_dat = (data_idx == PS2_PARTIAL) ? !UINT8_XOR(all_keys.front()) : \
@@ -71,6 +143,7 @@ void KEYBOARD::update_state(){
   }
 }
 
+#ifndef NVBOARD_HEADLESS
 static SDL_Surface* new_key_shape(int w, int h) {
   SDL_Surface *s = SDL_CreateRGBSurface(0, w, h, 32, 0xff0000, 0x00ff00, 0x0000ff, 0xff000000);
   uint32_t black = SDL_MapRGBA(s->format, 0, 0, 0, 0xff);
@@ -265,9 +338,12 @@ static void init_render_local(SDL_Renderer *renderer) {
   const char *str = "PS/2 Keyboard";
   draw_str(renderer, str, p[2].x - strlen(str) * CH_WIDTH, p[2].y - CH_HEIGHT / 2, 0xffffff);
 }
+#endif
 
 void init_keyboard(SDL_Renderer *renderer) {
-  init_render_local(renderer);
+#ifndef NVBOARD_HEADLESS
+  if (renderer != NULL) init_render_local(renderer);
+#endif
   kb = new KEYBOARD(renderer, 0, 0, KEYBOARD_TYPE);
   for (int p = PS2_CLK; p <= PS2_DAT; p ++) {
     kb->add_pin(p);
@@ -276,12 +352,18 @@ void init_keyboard(SDL_Renderer *renderer) {
 #define FILL_KEYMAP1(a) keys[SDL_PREFIX(a)].map1 = GET_SECOND(AT_PREFIX(a));
   MAP(SCANCODE_LIST, FILL_KEYMAP0)
   MAP(SCANCODE_LIST, FILL_KEYMAP1)
+
+  // the simulation thread is waiting in nvboard_init(), so it is safe to fill the queue here
+  const char *script = getenv("NVBOARD_KB_SCRIPT");
+  if (script != NULL) kb->load_script(script);
 }
 
 void kb_update() {
   kb->update_state();
 }
 
+#ifndef NVBOARD_HEADLESS
 void kb_push_key(uint8_t scancode, bool is_keydown){
   kb->push_key(scancode, is_keydown);
 }
+#endif
@@ -1,21 +1,167 @@
 #include <nvboard.h>
 #include <keyboard.h>
+#include <record.h>
 #include <stdarg.h>
 #include <macro.h>
+#include <atomic>
+#include <future>
+#include <thread>
 
 #define FPS 60
+// Without a render thread nobody requests snapshots, so the headless build
+// flushes the UART host output every this many cycles instead.
+#define HEADLESS_FLUSH_CYCLES (1 << 20)
 
 static SDL_Window *main_window = nullptr;
 static SDL_Renderer *main_renderer = nullptr;
 PinNode pin_array[NR_PINS];
+PinGroup pin_group[NR_PINS];
 
 static bool need_redraw = true;
 void set_redraw() { need_redraw = true; }
 
+// The simulation thread (the one calling nvboard_update()) only runs the
+// VGA, keyboard and UART state machines. Everything related to SDL lives in
+// the render thread, which talks to the simulation thread through a mailbox:
+//   - when `snapshot_req` is true, the mailbox belongs to the simulation
+//     thread, which publishes a new pin snapshot into the back buffer, runs
+//     the tasks posted by the render thread and clears `snapshot_req`;
+//   - when `snapshot_req` is false, the mailbox belongs to the render thread,
+//     which takes the new snapshot, hands over the pending tasks and sets
+//     `snapshot_req` again.
+// The render thread requests a snapshot once per frame, so the cost on the
+// simulation thread is a single load per cycle.
+static std::thread *render_thread = nullptr;
+static std::atomic<bool> snapshot_req(false);
+static std::atomic<bool> render_quit(false);
+static uint8_t pin_snapshot_buf[2][NR_PINS];
+static int snapshot_back = 0;
+uint8_t *pin_snapshot = pin_snapshot_buf[1];
+
+static std::vector<std::function<void()>> sim_tasks;     // owned by the mailbox
+static std::vector<std::function<void()>> pending_tasks; // owned by the render thread
+static std::vector<uint16_t> published_dirty_pins;       // owned by the mailbox
+
+// Change detection, maintained by the simulation thread. Output signals
+// registered by nvboard_bind_shadow() are gathered into a compact buffer and
+// compared word by word against the copy taken at the previous snapshot.
+// Only the pins of the signals that changed are sampled again, and they are
+// reported to the render thread, which then updates the components owning
+// them. Pins not covered by any shadow signal (bound manually, or wider than
+// 64 bits such as VlWide outputs) are sampled and compared every time.
+typedef struct {
+  void *ptr;
+  int size;
+  int offset;
+  std::vector<uint16_t> pins;
+} ShadowSignal;
+static std::vector<ShadowSignal> shadow_signals;
+static std::vector<uint64_t> shadow_live, shadow_last;
+static std::vector<std::vector<int>> shadow_word_signals; // signals overlapping each word
+static std::vector<uint16_t> unshadowed_pins;
+static uint8_t pin_state[NR_PINS];
+static std::vector<uint16_t> dirty_pins;
+
+void post_to_sim_thread(std::function<void()> task) {
+  pending_tasks.push_back(std::move(task));
+}
+
+static void sample_pin(int pin) {
+  uint8_t v = pin_peek(pin);
+  if (v != pin_state[pin]) {
+    pin_state[pin] = v;
+    dirty_pins.push_back(pin);
+  }
+}
+
+void post_pin_poke(uint16_t pin, int val) {
+  post_to_sim_thread([pin, val]() {
+    pin_poke(pin, val);
+    sample_pin(pin);
+  });
+}
+
+void nvboard_bind_shadow(void *signal, int size) {
+  // wide signals are left to the per-pin sampling in detect_pin_changes()
+  if (size != 1 && size != 2 && size != 4 && size != 8) return;
+  int offset = shadow_signals.empty() ? 0 :
+    shadow_signals.back().offset + shadow_signals.back().size;
+  offset = (offset + size - 1) & ~(size - 1);
+  shadow_signals.push_back((ShadowSignal){ .ptr = signal, .size = size, .offset = offset });
+}
+
+static void init_shadow() {
+  unshadowed_pins.clear();
+  for (int pin = 0; pin < NR_PINS; pin ++) {
+    bool shadowed = false;
+    for (auto &s : shadow_signals) {
+      if (pin_array[pin].ptr == s.ptr) { shadowed = true; break; }
+    }
+    if (!shadowed) unshadowed_pins.push_back(pin);
+  }
+  if (shadow_signals.empty()) return;
+  int nr_words = (shadow_signals.back().offset + shadow_signals.back().size + 7) / 8;
+  shadow_live.assign(nr_words, 0);
+  shadow_last.assign(nr_words, 0);
+  shadow_word_signals.assign(nr_words, std::vector<int>());
+  for (int i = 0; i < (int)shadow_signals.size(); i ++) {
+    ShadowSignal &s = shadow_signals[i];
+    for (int pin = 0; pin < NR_PINS; pin ++) {
+      if (pin_array[pin].ptr == s.ptr) s.pins.push_back(pin);
+    }
+    shadow_word_signals[s.offset / 8].push_back(i);
+  }
+}
+
+static inline void gather_shadow(uint8_t *buf) {
+  for (auto &s : shadow_signals) {
+    switch (s.size) {
+      case 1: memcpy(buf + s.offset, s.ptr, 1); break;
+      case 2: memcpy(buf + s.offset, s.ptr, 2); break;
+      case 4: memcpy(buf + s.offset, s.ptr, 4); break;
+      default: memcpy(buf + s.offset, s.ptr, 8); break;
+    }
+  }
+}
+
+static void detect_pin_changes() {
+  for (uint16_t pin : unshadowed_pins) { sample_pin(pin); }
+  if (shadow_signals.empty()) return;
+
+  uint64_t *live = shadow_live.data(), *last = shadow_last.data();
+  gather_shadow((uint8_t *)live);
+  int nr_words = shadow_live.size();
+  for (int w = 0; w < nr_words; w ++) {
+    if (likely(live[w] == last[w])) continue;
+    for (int i : shadow_word_signals[w]) {
+      for (uint16_t pin : shadow_signals[i].pins) { sample_pin(pin); }
+    }
+    last[w] = live[w];
+  }
+}
+
 void vga_update();
+void vga_update_gui();
 void kb_update();
 void uart_tx_receive();
 void uart_rx_send();
+void uart_publish();
+void uart_acquire();
+
+static void publish_snapshot() {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  for (auto &task : sim_tasks) { task(); }
+  sim_tasks.clear();
+
+  detect_pin_changes();
+  memcpy(pin_snapshot_buf[snapshot_back], pin_state, NR_PINS);
+  snapshot_back ^= 1;
+  published_dirty_pins.insert(published_dirty_pins.end(), dirty_pins.begin(), dirty_pins.end());
+  dirty_pins.clear();
+  uart_publish();
+
+  snapshot_req.store(false, std::memory_order_release);
+}
 
 void nvboard_update() {
   extern uint8_t *vga_blank_n_ptr;
@@ -24,39 +170,35 @@ void nvboard_update() {
   extern bool is_kb_idle;
   if (unlikely(!is_kb_idle)) kb_update();
 
-  extern int16_t uart_divisor_cnt;
+  extern int16_t uart_divisor_cnt, uart_tx_cnt;
   extern bool is_uart_rx_idle;
-  if (unlikely((-- uart_divisor_cnt) < 0)) {
-    uart_tx_receive();
-    if (unlikely(!is_uart_rx_idle)) uart_rx_send();
-  }
+  if (unlikely((-- uart_tx_cnt) < 0)) uart_tx_receive();
+  if (unlikely(!is_uart_rx_idle) && unlikely((-- uart_divisor_cnt) < 0)) uart_rx_send();
 
-  static uint64_t last = 0;
-  static int cpf = 1; // count per frame
-  static int cnt = 0;
-  if (unlikely((-- cnt) < 0)) {
-    uint64_t now = nvboard_get_time();
-    uint64_t diff = now - last;
-    if (diff == 0) return;
-    int cpf_new = ((uint64_t)cpf * 1000000) / ((uint64_t)diff * FPS); // adjust cpf
-    cnt += cpf_new - cpf;
-    cpf = cpf_new;
-    if (diff > 1000000 / FPS) {
-      last = now;
-      cnt = cpf;
-
-      void read_event();
-      read_event();
-      update_components(main_renderer);
-      if (need_redraw) {
-        SDL_RenderPresent(main_renderer);
-        need_redraw = false;
-      }
-    }
-  }
+  nvboard_cycles ++;
+  if (unlikely((-- record_sample_cnt) < 0)) record_sample();
+
+#ifdef NVBOARD_HEADLESS
+  if (unlikely((nvboard_cycles & (HEADLESS_FLUSH_CYCLES - 1)) == 0)) uart_publish();
+#endif
+  if (unlikely(snapshot_req.load(std::memory_order_relaxed))) publish_snapshot();
 }
 
-void nvboard_init(int vga_clk_cycle) {
+#ifndef NVBOARD_HEADLESS
+static void acquire_snapshot() {
+  if (snapshot_req.load(std::memory_order_acquire)) return; // nothing new yet
+
+  pin_snapshot = pin_snapshot_buf[snapshot_back ^ 1];
+  for (uint16_t pin : published_dirty_pins) { mark_pin_dirty(pin); }
+  published_dirty_pins.clear();
+  uart_acquire();
+  sim_tasks.swap(pending_tasks);
+  pending_tasks.clear();
+
+  snapshot_req.store(true, std::memory_order_release);
+}
+
+static void render_init(int vga_clk_cycle) {
     // init SDL and SDL_image
     SDL_Init(SDL_INIT_TIMER | SDL_INIT_VIDEO | SDL_INIT_EVENTS);
     IMG_Init(IMG_INIT_PNG);
@@ -77,10 +219,6 @@ void nvboard_init(int vga_clk_cycle) {
     SDL_SetRenderDrawColor(main_renderer, 0xff, 0xff, 0xff, 0);
     SDL_RenderFillRect(main_renderer, NULL);
 
-    for (int i = 0; i < NR_PINS; i ++) {
-      if (pin_array[i].ptr == NULL) pin_array[i].ptr = &pin_array[i].data;
-    }
-
     void init_font(SDL_Renderer *renderer);
     init_font(main_renderer);
     init_render(main_renderer);
@@ -90,19 +228,93 @@ void nvboard_init(int vga_clk_cycle) {
     void init_nvboard_timer();
     init_nvboard_timer();
 
+    // the simulation thread is waiting for us, so the pins can be sampled directly
+    for (int i = 0; i < NR_PINS; i ++) {
+      pin_state[i] = pin_peek(i);
+    }
+    memcpy(pin_snapshot, pin_state, NR_PINS);
+    init_shadow();
+    gather_shadow((uint8_t *)shadow_last.data());
+    init_dirty_components();
     update_components(main_renderer);
 
     extern void vga_set_clk_cycle(int cycle);
     vga_set_clk_cycle(vga_clk_cycle);
 }
 
-void nvboard_quit(){
+static void render_loop() {
+  void read_event();
+  uint64_t next = nvboard_get_time();
+  while (!render_quit.load(std::memory_order_relaxed)) {
+    read_event();
+    acquire_snapshot();
+    update_components(main_renderer);
+    vga_update_gui();
+    if (need_redraw) {
+      SDL_RenderPresent(main_renderer);
+      need_redraw = false;
+    }
+
+    next += 1000000 / FPS;
+    uint64_t now = nvboard_get_time();
+    if (now < next) std::this_thread::sleep_for(std::chrono::microseconds(next - now));
+    else next = now;
+  }
+}
+
+static void render_quit_internal() {
     delete_components();
     SDL_DestroyWindow(main_window);
     SDL_DestroyRenderer(main_renderer);
     IMG_Quit();
     SDL_Quit();
 }
+#endif
+
+void nvboard_init(int vga_clk_cycle) {
+    for (int i = 0; i < NR_PINS; i ++) {
+      if (pin_array[i].ptr == NULL) pin_array[i].ptr = &pin_array[i].data;
+    }
+
+#ifdef NVBOARD_HEADLESS
+    // no window, no render thread: only the state machines driven by
+    // nvboard_update() are created, and the outputs go to the record file
+    void init_nvboard_timer();
+    init_nvboard_timer();
+    void init_keyboard(SDL_Renderer *renderer);
+    void init_vga(SDL_Renderer *renderer);
+    void init_uart(SDL_Renderer *renderer);
+    init_keyboard(NULL);
+    init_vga(NULL);
+    init_uart(NULL);
+    extern void vga_set_clk_cycle(int cycle);
+    vga_set_clk_cycle(vga_clk_cycle);
+#else
+    std::promise<void> ready;
+    std::future<void> ready_future = ready.get_future();
+    render_thread = new std::thread([vga_clk_cycle, &ready]() {
+      render_init(vga_clk_cycle);
+      ready.set_value();
+      render_loop();
+      render_quit_internal();
+    });
+    ready_future.wait();
+#endif
+
+    init_record();
+}
+
+void nvboard_quit(){
+    finish_record();
+#ifdef NVBOARD_HEADLESS
+    delete_components();
+#else
+    render_quit.store(true, std::memory_order_relaxed);
+    render_thread->join();
+    delete render_thread;
+    render_thread = nullptr;
+#endif
+}
 
 void nvboard_bind_pin(void *signal, int len, ...) {
   assert(len < 64);
@@ -116,3 +328,12 @@ void nvboard_bind_pin(void *signal, int len, ...) {
   }
   va_end(ap);
 }
+
+void nvboard_bind_group(int lsb_pin, int len, void *signal, int size, int offset) {
+  assert(size == 1 || size == 2 || size == 4 || size == 8);
+  assert(len < 64 && offset + len <= size * 8);
+  pin_group[lsb_pin].ptr = signal;
+  pin_group[lsb_pin].size = size;
+  pin_group[lsb_pin].len = len;
+  pin_group[lsb_pin].offset = offset;
+}
@@ -0,0 +1,94 @@
+#include <nvboard.h>
+#include <record.h>
+
+uint64_t nvboard_cycles = 0;
+int64_t record_sample_cnt = INT64_MAX; // never reaches zero when not recording
+
+static FILE *record_fp = NULL;
+static int record_interval = RECORD_DEFAULT_INTERVAL;
+static uint32_t last_led = 0;
+static uint8_t last_seg7[8] = {};
+
+bool is_recording() {
+  return record_fp != NULL;
+}
+
+void record_event(int type, int index, uint32_t value) {
+  RecordEntry e = { .cycle = nvboard_cycles, .type = (uint8_t)type,
+    .index = (uint8_t)index, .reserved = 0, .value = value };
+  fwrite(&e, sizeof(e), 1, record_fp);
+}
+
+static uint32_t sample_led() {
+  uint32_t v = 0;
+  for (int i = 0; i < 16; i ++) {
+    v |= pin_peek(LD0 + i) << i;
+  }
+  return v;
+}
+
+static uint8_t sample_seg7(int digit) {
+  int sega = SEG0A + 8 * digit;
+  uint8_t v = 0;
+  for (int i = 0; i < 8; ++i) {
+    v |= pin_peek(sega + 7 - i) << i;
+  }
+  return v;
+}
+
+// called by the simulation thread every `record_interval` cycles
+void record_sample() {
+  record_sample_cnt = record_interval - 1;
+  uint32_t led = sample_led();
+  if (led != last_led) {
+    last_led = led;
+    record_event(RECORD_LED, 0, led);
+  }
+  for (int i = 0; i < 8; i ++) {
+    uint8_t seg = sample_seg7(i);
+    if (seg != last_seg7[i]) {
+      last_seg7[i] = seg;
+      record_event(RECORD_SEG7, i, seg);
+    }
+  }
+}
+
+uint32_t record_hash(const uint32_t *pixels, int n) {
+  uint32_t h = 2166136261u;
+  for (int i = 0; i < n; i ++) {
+    h = (h ^ pixels[i]) * 16777619u;
+  }
+  return h;
+}
+
+void init_record() {
+  const char *path = getenv("NVBOARD_RECORD");
+  if (path == NULL) return;
+  record_fp = fopen(path, "wb");
+  if (record_fp == NULL) {
+    printf("NVBoard: cannot open record file %s\n", path);
+    return;
+  }
+  const char *interval = getenv("NVBOARD_RECORD_INTERVAL");
+  if (interval != NULL && atoi(interval) > 0) record_interval = atoi(interval);
+
+  RecordHeader h = { .magic = RECORD_MAGIC, .version = RECORD_VERSION,
+    .interval = (uint32_t)record_interval };
+  fwrite(&h, sizeof(h), 1, record_fp);
+
+  // initial state of the board
+  last_led = sample_led();
+  record_event(RECORD_LED, 0, last_led);
+  for (int i = 0; i < 8; i ++) {
+    last_seg7[i] = sample_seg7(i);
+    record_event(RECORD_SEG7, i, last_seg7[i]);
+  }
+  record_sample_cnt = record_interval - 1;
+}
+
+void finish_record() {
+  if (record_fp == NULL) return;
+  fclose(record_fp);
+  record_fp = NULL;
+  record_sample_cnt = INT64_MAX;
+}
@@ -57,20 +57,15 @@ void draw_surrounding_line(SDL_Renderer *renderer, SDL_Rect r,
   draw_thicker_line(renderer, p, 9);
 }
 
-static void draw_str_internal(SDL_Renderer *renderer, SDL_Texture *t, const char *str, int x, int y) {
-  SDL_Rect r = Rect(x, y, CH_WIDTH * strlen(str), CH_HEIGHT);
-  SDL_RenderCopy(renderer, t, NULL, &r);
-  SDL_DestroyTexture(t);
-}
-
 void draw_str(SDL_Renderer *renderer, const char *str, int x, int y, uint32_t fg) {
-  SDL_Texture *t = str2texture(renderer, str, fg);
-  draw_str_internal(renderer, t, str, x, y);
+  draw_glyphs(renderer, (const uint8_t *)str, strlen(str), x, y, fg);
 }
 
 void draw_str(SDL_Renderer *renderer, const char *str, int x, int y, uint32_t fg, uint32_t bg) {
-  SDL_Texture *t = str2texture(renderer, str, fg, bg);
-  draw_str_internal(renderer, t, str, x, y);
+  SDL_Rect r = Rect(x, y, CH_WIDTH * strlen(str), CH_HEIGHT);
+  SDL_SetRenderDrawColor(renderer, (bg >> 16) & 0xff, (bg >> 8) & 0xff, bg & 0xff, 0);
+  SDL_RenderFillRect(renderer, &r);
+  draw_glyphs(renderer, (const uint8_t *)str, strlen(str), x, y, fg);
 }
 
 
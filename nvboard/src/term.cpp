@@ -132,34 +132,42 @@ void Term::draw_cursor() {
     rect.w = CH_WIDTH, rect.h = CH_HEIGHT;
     rect.y += CH_HEIGHT * y;
     rect.x += CH_WIDTH * x;
-    SDL_Texture *t = is_cursor_visible ? (is_focus ? get_focus_cursor_texture :
-                                          cursor_texture) :  ch2texture_term(' ');
-    SDL_RenderCopy(renderer, t, NULL, &rect);
+    if (is_cursor_visible) {
+      SDL_Texture *t = is_focus ? get_focus_cursor_texture : cursor_texture;
+      SDL_RenderCopy(renderer, t, NULL, &rect);
+    } else {
+      SDL_SetRenderDrawColor(renderer, 0xff, 0xff, 0xff, 0);
+      SDL_RenderFillRect(renderer, &rect);
+    }
     set_redraw();
   }
 }
 
 void Term::update_gui() {
   if (!dirty_screen) return;
+  SDL_SetRenderDrawColor(renderer, 0xff, 0xff, 0xff, 0);
   SDL_Rect rect = region;
-  int x_start = rect.x;
-  rect.w = CH_WIDTH, rect.h = CH_HEIGHT;
+  rect.h = CH_HEIGHT;
   for (int y = 0; y < h_in_char; y ++) {
     if (screen_y + y >= lines.size()) break;
     if (!dirty_line[y]) continue;
 
+    // redraw each run of dirty characters: clear the background once,
+    // then draw the glyphs of the run from the atlas
     uint8_t *l = lines[screen_y + y];
     rect.y = region.y + rect.h * y;
     bool *dirty = &dirty_char[y * w_in_char];
-    for (int x = 0; x < w_in_char; x ++) {
-      if (!dirty[x]) continue;
-
-      uint8_t ch = l[x];
-      rect.x = region.x + rect.w * x;
-      SDL_Texture *t  = ch2texture_term(ch);
-      SDL_RenderCopy(renderer, t, NULL, &rect);
-      set_redraw();
+    int x = 0;
+    while (x < w_in_char) {
+      if (!dirty[x]) { x ++; continue; }
+      int x_start = x;
+      while (x < w_in_char && dirty[x]) { x ++; }
+      rect.x = region.x + CH_WIDTH * x_start;
+      rect.w = CH_WIDTH * (x - x_start);
+      SDL_RenderFillRect(renderer, &rect);
+      draw_glyphs(renderer, l + x_start, x - x_start, rect.x, rect.y, 0x000000);
     }
+    set_redraw();
   }
   draw_cursor();
   init_dirty(false);
@@ -1,50 +1,91 @@
 #include <nvboard.h>
 #include <uart.h>
+#include <record.h>
 
 // There is no need to update TX too frequently
 #define UART_TX_FPS 5
 
 static UART* uart = NULL;
-int16_t uart_divisor_cnt = 0;
+int16_t uart_divisor_cnt = 0; // paces rx_send()
+int16_t uart_tx_cnt = 0;      // paces tx_receive()
 bool is_uart_rx_idle = true;
 
 UART::UART(SDL_Renderer *rend, int cnt, int init_val, int ct, int x, int y, int w, int h):
     Component(rend, cnt, init_val, ct),
     tx_state(0), rx_state(0), divisor(16), need_update_gui(false) {
-  term = new Term(rend, x, y, w, h);
+#ifndef NVBOARD_HEADLESS
+  term = (rend != NULL) ? new Term(rend, x, y, w, h) : NULL;
+#else
+  term = NULL;
+#endif
 
   SDL_Rect *rect_ptr = new SDL_Rect;
   *rect_ptr = (SDL_Rect){x, y, w, h};
   set_rect(rect_ptr, 0);
 
+  // The bit period must match the baud divisor of the RTL. Lower it (with
+  // NVBOARD_UART_DIVISOR) together with the RTL to move bytes faster.
+  const char *div = getenv("NVBOARD_UART_DIVISOR");
+  if (div != NULL && atoi(div) > 0) divisor = atoi(div);
+  // In transactor mode the TX line is watched every cycle while idle, and
+  // each bit is sampled in the middle of its period once a start bit is
+  // seen, so that whole bytes are taken reliably from the frame even at
+  // divisors of a few cycles.
+  const char *fast = getenv("NVBOARD_TRANSACTOR");
+  transactor = (fast != NULL && strcmp(fast, "1") == 0);
+
   uart_divisor_cnt = divisor - 1;
+  uart_tx_cnt = transactor ? 0 : divisor - 1;
   int len = pin_array[UART_TX].vector_len;
   assert(len == 0 || len == 1); // either unbound or bound to 1 bit signal
   p_tx = (uint8_t *)pin_array[UART_TX].ptr;
 
-  SDL_SetRenderDrawColor(rend, 0x00, 0x00, 0x00, 0);
-  SDL_RenderDrawLine(rend, x, y + h, x + w, y + h);
-  SDL_SetRenderDrawColor(rend, 0xff, 0xff, 0xff, 0);
+#ifndef NVBOARD_HEADLESS
+  if (rend != NULL) {
+    SDL_SetRenderDrawColor(rend, 0x00, 0x00, 0x00, 0);
+    SDL_RenderDrawLine(rend, x, y + h, x + w, y + h);
+    SDL_SetRenderDrawColor(rend, 0xff, 0xff, 0xff, 0);
+  }
+#endif
 
   rx_sending_str = "";
   pin_poke(UART_RX, 1);
+
+  // Besides the terminal, received bytes can also be written to a host file
+  // or named pipe, so that the console can be checked by a script. The
+  // stream is line buffered and flushed once per frame.
+  host_out = NULL;
+  const char *path = getenv("NVBOARD_UART_TX_OUT");
+  if (path != NULL) {
+    host_out = fopen(path, "w");
+    if (host_out == NULL) printf("NVBoard: cannot open UART output %s\n", path);
+    else setvbuf(host_out, NULL, _IOLBF, 0);
+  }
 }
 
 UART::~UART() {
-  SDL_DestroyTexture(get_texture(0));
+#ifndef NVBOARD_HEADLESS
+  if (get_texture(0) != NULL) SDL_DestroyTexture(get_texture(0));
+  delete term;
+#endif
+  if (host_out != NULL) fclose(host_out);
 }
 
 void UART::update_gui() { // everything is done in update_state()
 }
 
 void UART::tx_receive() {
-  uart_divisor_cnt = divisor - 1;
+  uart_tx_cnt = divisor - 1;
 
   uint8_t tx = *p_tx;
   if (tx_state == 0) { // idle
     if (!tx) { // start bit
       tx_data = 0;
       tx_state ++;
+      // the falling edge was just seen: wait for the middle of data bit 0
+      if (transactor) uart_tx_cnt = divisor + divisor / 2 - 1;
+    } else if (transactor) {
+      uart_tx_cnt = 0;
     }
   } else if (tx_state >= 1 && tx_state <= 8) { // data
     tx_data = (tx << 7) | (tx_data >> 1);  // data bit
@@ -52,14 +93,16 @@ void UART::tx_receive() {
   } else if (tx_state == 9) {
     if (tx) { // stop bit
       tx_state = 0;
-      term->feed_ch(tx_data);
-      need_update_gui = true;
+      if (transactor) uart_tx_cnt = 0;
+      if (term != NULL) tx_pending += tx_data;
+      if (host_out != NULL) fputc(tx_data, host_out);
+      if (is_recording()) record_event(RECORD_UART, 0, tx_data);
     }
   }
 }
 
 void UART::rx_send() {
-  // the uart_divisor_cnt is maintained in tx_receive()
+  uart_divisor_cnt = divisor - 1;
   if (rx_state == 0) { // idle
     rx_data = rx_sending_str[0];
     if (rx_data == '\0') {
@@ -84,7 +127,26 @@ void UART::rx_getchar(uint8_t ch) {
   is_uart_rx_idle = false;
 }
 
+// called by the simulation thread when publishing a snapshot
+void UART::publish() {
+  if (host_out != NULL) fflush(host_out);
+  if (tx_pending.empty()) return;
+  tx_published += tx_pending;
+  tx_pending.clear();
+}
+
+// called by the render thread when acquiring a snapshot
+void UART::acquire() {
+#ifndef NVBOARD_HEADLESS
+  if (tx_published.empty()) return;
+  for (auto ch : tx_published) { term->feed_ch(ch); }
+  tx_published.clear();
+  need_update_gui = true;
+#endif
+}
+
 void UART::update_state() {
+#ifndef NVBOARD_HEADLESS
   if (need_update_gui) {
     static uint64_t last = 0;
     uint64_t now = nvboard_get_time();
@@ -94,6 +156,7 @@ void UART::update_state() {
       term->update_gui();
     }
   }
+#endif
 }
 
 void UART::set_divisor(uint16_t d) {
@@ -101,9 +164,12 @@ void UART::set_divisor(uint16_t d) {
 }
 
 void UART::term_focus(bool v) {
+#ifndef NVBOARD_HEADLESS
   term->set_focus(v);
+#endif
 }
 
+#ifndef NVBOARD_HEADLESS
 static void init_render_local(SDL_Renderer *renderer) {
   SDL_SetRenderDrawColor(renderer, 0xff, 0xff, 0xff, 0);
   SDL_Point p[2];
@@ -117,9 +183,12 @@ static void init_render_local(SDL_Renderer *renderer) {
   }
   draw_str(renderer, "UART-[", p[1].x - 8 * CH_WIDTH, p[1].y + CH_HEIGHT, 0xffffff);
 }
+#endif
 
 void init_uart(SDL_Renderer *renderer) {
-  init_render_local(renderer);
+#ifndef NVBOARD_HEADLESS
+  if (renderer != NULL) init_render_local(renderer);
+#endif
   int x = WINDOW_WIDTH / 2, y = 0, w = WINDOW_WIDTH / 2, h = WINDOW_HEIGHT / 2;
   uart = new UART(renderer, 1, 0, UART_TYPE, x, y, w, h);
   uart->add_pin(UART_TX);
@@ -136,7 +205,15 @@ void uart_rx_send() {
 }
 
 void uart_rx_getchar(uint8_t ch) {
-  uart->rx_getchar(ch);
+  post_to_sim_thread([ch]() { uart->rx_getchar(ch); });
+}
+
+void uart_publish() {
+  uart->publish();
+}
+
+void uart_acquire() {
+  uart->acquire();
 }
 
 void uart_term_focus(bool v) {
@@ -1,5 +1,6 @@
 #include <nvboard.h>
 #include <vga.h>
+#include <record.h>
 #include <macro.h>
 
 static VGA* vga = NULL;
@@ -24,17 +25,35 @@ VGA::VGA(SDL_Renderer *rend, int cnt, int init_val, int ct):
     Component(rend, cnt, init_val, ct),
     vga_screen_width(VGA_DEFAULT_WIDTH), vga_screen_height(VGA_DEFAULT_HEIGHT),
     vga_clk_cnt(1) {
-  SDL_Texture *vga_texture = SDL_CreateTexture(rend, SDL_PIXELFORMAT_ARGB8888,
-    SDL_TEXTUREACCESS_STREAMING, vga_screen_width, vga_screen_height);
+  SDL_Texture *vga_texture = NULL;
+#ifndef NVBOARD_HEADLESS
+  if (rend != NULL) {
+    vga_texture = SDL_CreateTexture(rend, SDL_PIXELFORMAT_ARGB8888,
+      SDL_TEXTUREACCESS_STREAMING, vga_screen_width, vga_screen_height);
+  }
+#endif
   set_texture(vga_texture, 0);
   pixels = new uint32_t[vga_screen_width * vga_screen_height];
   memset(pixels, 0, vga_screen_width * vga_screen_height * sizeof(uint32_t));
+  pixels_front = new uint32_t[vga_screen_width * vga_screen_height];
+  memset(pixels_front, 0, vga_screen_width * vga_screen_height * sizeof(uint32_t));
+  line = new uint32_t[vga_screen_width];
+  row_dirty = new bool[vga_screen_height];
+  memset(row_dirty, 0, vga_screen_height * sizeof(bool));
+  front_row_dirty = new bool[vga_screen_height];
+  memset(front_row_dirty, 0, vga_screen_height * sizeof(bool));
+  is_frame_dirty = false;
+  is_frame_ready = false;
 
   SDL_Rect *rect_ptr = new SDL_Rect;
   *rect_ptr = (SDL_Rect){0, WINDOW_HEIGHT / 2, VGA_DEFAULT_WIDTH, VGA_DEFAULT_HEIGHT};
   set_rect(rect_ptr, 0);
-  SDL_UpdateTexture(vga_texture, NULL, pixels, vga_screen_width * sizeof(uint32_t));
-  SDL_RenderCopy(rend, vga_texture, NULL, rect_ptr);
+#ifndef NVBOARD_HEADLESS
+  if (rend != NULL) {
+    SDL_UpdateTexture(vga_texture, NULL, pixels, vga_screen_width * sizeof(uint32_t));
+    SDL_RenderCopy(rend, vga_texture, NULL, rect_ptr);
+  }
+#endif
 
   is_r_len8 = pin_array[VGA_R0].vector_len == 8;
   is_g_len8 = pin_array[VGA_G0].vector_len == 8;
@@ -43,28 +62,64 @@ VGA::VGA(SDL_Renderer *rend, int cnt, int init_val, int ct):
   if (is_r_len8) p_r = (uint8_t *)pin_array[VGA_R0].ptr;
   if (is_g_len8) p_g = (uint8_t *)pin_array[VGA_G0].ptr;
   if (is_b_len8) p_b = (uint8_t *)pin_array[VGA_B0].ptr;
+  // groups registered by the generated binding code
+  is_r_group = pin_group[VGA_R0].len == 8;
+  is_g_group = pin_group[VGA_G0].len == 8;
+  is_b_group = pin_group[VGA_B0].len == 8;
+  // R, G and B packed into one signal, e.g. `rgb[23:0]`, are read with a single load
+  p_rgb = pin_group[VGA_B0].ptr;
+  rgb_offset = pin_group[VGA_B0].offset;
+  is_rgb_64 = pin_group[VGA_B0].size == 8;
+  is_rgb_packed = is_r_group && is_g_group && is_b_group &&
+    pin_group[VGA_R0].ptr == p_rgb && pin_group[VGA_G0].ptr == p_rgb &&
+    pin_group[VGA_R0].offset == rgb_offset + 16 && pin_group[VGA_G0].offset == rgb_offset + 8 &&
+    pin_group[VGA_B0].size >= 4;
   int vga_blank_n_len = pin_array[VGA_BLANK_N].vector_len;
   assert(vga_blank_n_len == 1 || vga_blank_n_len == 0);
   vga_blank_n_ptr = (uint8_t *)pin_array[VGA_BLANK_N].ptr;
-  p_pixel = pixels;
-  p_pixel_end = pixels + vga_screen_width * vga_screen_height;
+  p_pixel = line;
+  p_line_end = line + vga_screen_width;
+  line_y = 0;
 }
 
 VGA::~VGA() {
-  SDL_DestroyTexture(get_texture(0));
+#ifndef NVBOARD_HEADLESS
+  if (get_texture(0) != NULL) SDL_DestroyTexture(get_texture(0));
+#endif
   delete []pixels;
+  delete []pixels_front;
+  delete []line;
+  delete []row_dirty;
+  delete []front_row_dirty;
 }
 
+// called by the render thread
 void VGA::update_gui() {
+#ifndef NVBOARD_HEADLESS
+  if (!is_frame_ready.load(std::memory_order_acquire)) return;
 #ifdef DEBUG
   static int frames = 0;
   frames ++;
   printf("%d frames\n", frames);
 #endif
   SDL_Texture *vga_texture = get_texture(0);
-  SDL_UpdateTexture(vga_texture, NULL, pixels, vga_screen_width * sizeof(uint32_t));
+  {
+    // only upload the runs of rows which changed
+    std::lock_guard<std::mutex> lock(frame_lock);
+    int y = 0;
+    while (y < vga_screen_height) {
+      if (!front_row_dirty[y]) { y ++; continue; }
+      int y_start = y;
+      while (y < vga_screen_height && front_row_dirty[y]) { front_row_dirty[y ++] = false; }
+      SDL_Rect r = Rect(0, y_start, vga_screen_width, y - y_start);
+      SDL_UpdateTexture(vga_texture, &r, pixels_front + y_start * vga_screen_width,
+          vga_screen_width * sizeof(uint32_t));
+    }
+    is_frame_ready.store(false, std::memory_order_relaxed);
+  }
   SDL_RenderCopy(get_renderer(), vga_texture, NULL, get_rect(0));
   set_redraw();
+#endif
 }
 
 uint32_t VGA::get_pixel_color_slowpath() {
@@ -75,18 +130,51 @@ uint32_t VGA::get_pixel_color_slowpath() {
                        f(color, 4) f(color, 5) f(color, 6) f(color, 7)
 #define GET_COLOR_BIT_REDUCE(color, n) GET_COLOR_BIT(color, n) |
 #define GET_COLOR(color) MAP2(BITS, GET_COLOR_BIT_REDUCE, color) 0
-  int r = is_r_len8 ? *p_r : GET_COLOR(R);
-  int g = is_g_len8 ? *p_g : GET_COLOR(G);
-  int b = is_b_len8 ? *p_b : GET_COLOR(B);
+  int r = is_r_len8 ? *p_r : is_r_group ? pin_group_peek(VGA_R0) : GET_COLOR(R);
+  int g = is_g_len8 ? *p_g : is_g_group ? pin_group_peek(VGA_G0) : GET_COLOR(G);
+  int b = is_b_len8 ? *p_b : is_b_group ? pin_group_peek(VGA_B0) : GET_COLOR(B);
   uint32_t color = (r << 16) | (g << 8) | b;
   return color;
 }
 
-__attribute__((noinline)) void VGA::finish_one_frame() {
-  p_pixel = pixels;
-  if (!is_pixels_same) {
-    update_gui();
-    is_pixels_same = true;
+void VGA::finish_one_frame() {
+  line_y = 0;
+  if (!is_frame_dirty) return;
+  if (is_recording()) {
+    record_event(RECORD_VGA, 0, record_hash(pixels, vga_screen_width * vga_screen_height));
+  }
+#ifdef NVBOARD_HEADLESS
+  memset(row_dirty, 0, vga_screen_height * sizeof(bool));
+  is_frame_dirty = false;
+#else
+  std::lock_guard<std::mutex> lock(frame_lock);
+  for (int y = 0; y < vga_screen_height; y ++) {
+    if (!row_dirty[y]) continue;
+    memcpy(pixels_front + y * vga_screen_width, pixels + y * vga_screen_width,
+        vga_screen_width * sizeof(uint32_t));
+    front_row_dirty[y] = true;
+    row_dirty[y] = false;
+  }
+  is_frame_dirty = false;
+  is_frame_ready.store(true, std::memory_order_release);
+#endif
+}
+
+// A whole scanline is captured into `line` first, and compared with the
+// frame buffer only once it is complete. memcmp()/memcpy() on a full row
+// are vectorized by the C library, which is much cheaper than comparing
+// pixel by pixel in update_state().
+__attribute__((noinline)) void VGA::finish_one_line() {
+  p_pixel = line;
+  uint32_t *row = pixels + line_y * vga_screen_width;
+  if (memcmp(row, line, vga_screen_width * sizeof(uint32_t)) != 0) {
+    memcpy(row, line, vga_screen_width * sizeof(uint32_t));
+    row_dirty[line_y] = true;
+    is_frame_dirty = true;
+  }
+  line_y ++;
+  if (unlikely(line_y == vga_screen_height)) {
+    finish_one_frame();
   }
 }
 
@@ -97,14 +185,16 @@ void VGA::update_state() {
   }
 
   uint32_t color = 0;
-  if (likely(is_all_len8)) color = ((*p_r) << 16) | ((*p_g) << 8) | (*p_b);
-  else                     color = get_pixel_color_slowpath();
-  bool is_same = (*p_pixel == color);
-  is_pixels_same &= is_same;
+  if (likely(is_rgb_packed)) {
+    uint64_t v = is_rgb_64 ? *(uint64_t *)p_rgb : *(uint32_t *)p_rgb;
+    color = (v >> rgb_offset) & 0xffffff;
+  }
+  else if (likely(is_all_len8)) color = ((*p_r) << 16) | ((*p_g) << 8) | (*p_b);
+  else                          color = get_pixel_color_slowpath();
   *p_pixel = color;
   p_pixel ++;
-  if (unlikely(p_pixel == p_pixel_end)) {
-    finish_one_frame();
+  if (unlikely(p_pixel == p_line_end)) {
+    finish_one_line();
   }
 }
 
@@ -112,6 +202,7 @@ void vga_set_clk_cycle(int cycle) {
   vga_clk_cycle_minus_1 = cycle - 1;
 }
 
+#ifndef NVBOARD_HEADLESS
 static void init_render_local(SDL_Renderer *renderer) {
   // draw line
   SDL_SetRenderDrawColor(renderer, 0xff, 0xff, 0xff, 0);
@@ -124,9 +215,12 @@ static void init_render_local(SDL_Renderer *renderer) {
   // draw label
   draw_str(renderer, "VGA", p[0].x + 4, p[0].y - CH_HEIGHT / 2, 0xffffff);
 }
+#endif
 
 void init_vga(SDL_Renderer *renderer) {
-  init_render_local(renderer);
+#ifndef NVBOARD_HEADLESS
+  if (renderer != NULL) init_render_local(renderer);
+#endif
   vga = new VGA(renderer, 1, 0, VGA_TYPE);
   for (int p = VGA_VSYNC; p <= VGA_B7; p ++) {
     vga->add_pin(p);
@@ -136,3 +230,7 @@ void init_vga(SDL_Renderer *renderer) {
 void vga_update() {
   vga->update_state();
 }
+
+void vga_update_gui() {
+  vga->update_gui();
+}